@@ -0,0 +1,96 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Harvey Bates
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/**
+ * @brief Times the batch mils to millimeters conversion against converting
+ * one value per call (as the symbol builders did before).
+ *
+ * @example kandle_bench_mils_to_millimeters
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include "utils.hpp"
+
+static const std::size_t TOTAL_VALUES = 1 << 26;
+
+template <typename Convert>
+static double time_per_value(std::size_t count, Convert convert) {
+    std::vector<int> mils(count);
+    std::vector<double> millimeters(count);
+    for (std::size_t i = 0; i < count; i++) {
+        mils[i] = (int) (i * 50) - 2500;
+    }
+
+    double sum = 0;
+    std::size_t rounds = TOTAL_VALUES / count;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t round = 0; round < rounds; round++) {
+        convert(mils.data(), millimeters.data(), count);
+        sum += millimeters[round % count];
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    // Keeps the conversions from being optimised away
+    if (sum == 0.5) {
+        std::printf("%f\n", sum);
+    }
+
+    std::chrono::duration<double, std::nano> elapsed = end - start;
+    return elapsed.count() / (double) (rounds * count);
+}
+
+int main() {
+    // Same choice as Utils::mils_to_millimeters() (made at runtime on x86)
+#if defined(__AVX2__)
+    std::printf("mils_to_millimeters (AVX2)\n");
+#elif defined(__GNUC__) && defined(__SSE2__)
+    std::printf("mils_to_millimeters (%s)\n",
+                __builtin_cpu_supports("avx2") ? "AVX2" : "SSE2");
+#elif defined(__SSE2__)
+    std::printf("mils_to_millimeters (SSE2)\n");
+#else
+    std::printf("mils_to_millimeters (scalar)\n");
+#endif
+    std::printf("%8s %16s %16s\n", "values", "per call ns", "batch ns");
+
+    for (std::size_t count: {8, 64, 512, 4096}) {
+        double single = time_per_value(count,
+                [](const int* mils, double* millimeters, std::size_t n) {
+            for (std::size_t i = 0; i < n; i++) {
+                millimeters[i] = Utils::mils_to_millimeters(mils[i]);
+            }
+        });
+        double batch = time_per_value(count,
+                [](const int* mils, double* millimeters, std::size_t n) {
+            Utils::mils_to_millimeters(mils, millimeters, n);
+        });
+
+        std::printf("%8zu %16.3f %16.3f\n", count, single, batch);
+    }
+
+    return 0;
+}
@@ -0,0 +1,85 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Harvey Bates
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/**
+ * @brief Times rendering a .kicad_sym library from an already parsed legacy
+ * library into memory (parsing is not timed).
+ *
+ * @example kandle_bench_symbol path/to/library.lib [runs]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include "eschema/legacy.hpp"
+#include "eschema/release.hpp"
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::printf("Usage: %s <library.lib> [runs]\n", argv[0]);
+        return 1;
+    }
+    int runs = argc > 2 ? std::atoi(argv[2]) : 20;
+
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file.is_open()) {
+        std::printf("Unable to open: %s\n", argv[1]);
+        return 1;
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    std::string library = contents.str();
+
+    Legacy legacy;
+    if (!legacy.convert(library)) {
+        std::printf("Unable to parse: %s\n", argv[1]);
+        return 1;
+    }
+
+    double best = 0, total = 0;
+    for (int run = 0; run < runs; run++) {
+        auto start = std::chrono::steady_clock::now();
+        Symbol symbol;
+        std::string rendered;
+        if (!symbol.render(&legacy, rendered)) {
+            std::printf("Unable to build symbols\n");
+            return 1;
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        std::chrono::duration<double, std::milli> elapsed = end - start;
+        total += elapsed.count();
+        if (run == 0 || elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+
+    std::printf("%zu components, %d runs: best %.2f ms, mean %.2f ms\n",
+                legacy.components.size(), runs, best, total / runs);
+
+    return 0;
+}
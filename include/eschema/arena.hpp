@@ -0,0 +1,76 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Harvey Bates
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+/**
+ * @brief Scratch memory for a conversion. Allocations bump a pointer and are
+ * never freed individually, everything is released at once by reset().
+ *
+ * @note Unlike std::pmr::monotonic_buffer_resource, reset() keeps the memory
+ * (merged into one block), so converting one component after another stops
+ * calling malloc once the arena is as large as the biggest component.
+ *
+ * @note Not thread safe, each thread needs its own arena.
+ */
+class Arena : public std::pmr::memory_resource {
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        std::size_t size;
+    };
+
+    static constexpr std::size_t MIN_BLOCK_SIZE = 64 * 1024;
+
+    std::vector<Block> blocks;
+    std::size_t used = 0; // Bytes used in the last block
+    std::size_t capacity = 0; // Bytes in all blocks
+
+    void add_block(std::size_t size);
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+    void do_deallocate(void* p, std::size_t bytes,
+                       std::size_t alignment) override;
+
+    bool do_is_equal(
+            const std::pmr::memory_resource& other) const noexcept override;
+
+public:
+    Arena() = default;
+
+    Arena(const Arena&) = delete;
+
+    Arena& operator=(const Arena&) = delete;
+
+    void reset();
+};
@@ -24,37 +24,45 @@
 
 #pragma once
 
-#include <tuple>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
 #include <vector>
 
 class Component {
 public:
 
+    // Text held in the string table of a component (see LegacyComponent)
+    struct StringRef {
+        uint32_t offset{};
+        uint32_t length{};
+    };
+
     // This information comes from the "DEF" identifier
     struct Definition {
-        char name[255]{};
-        char reference[255]{};
+        StringRef name;
+        StringRef reference;
         int pin_name_offset{};
+        int num_units{};
         char show_pin_number{};
         char show_pin_name{};
-        int num_units{};
         char pwr_cmp{};
     };
 
     // This comes from F0 ... Fn
     struct Information {
-        char text[255]{};
+        StringRef text;
+        StringRef field_name;
         int pos_x{};
         int pos_y{};
         int dimension{};
+        int font_size{};
         char orientation{}; // H (horizontal) or V (vert)
         char visibility{}; // V (visible) or I (invisible)
-        int font_size{};
         char horizontal_justification{};
         char vertical_justification{};
         char italic{};
         char bold{};
-        char field_name[255]{};
     };
 
     enum PinElectricalType : char {
@@ -72,19 +80,19 @@ public:
     };
 
     struct Pin {
-        char name[255]{};
-        char number[4]{};
+        StringRef name;
+        StringRef number;
+        // If shape starts with 'N' then invisible
+        StringRef shape; // Optional
         int pos_x;
         int pos_y;
         int length;
-        char orientation;
         int text_num_size;
         int text_name_size;
         int unit;
         int convert;
+        char orientation;
         char electric_type; // Input, output etc.
-        // If shape[0] == 'N' then invisible
-        char shape[4]{}; // Optional
     };
 
     struct Rectangle {
@@ -98,12 +106,14 @@ public:
         char background;
     };
 
+    // Points are held by the component (see LegacyComponent::points), the
+    // polygon refers to n_points of them starting at first_point
     struct Polygon {
         int n_points;
         int parts;
         int convert;
         int thickness;
-        std::vector<std::tuple<int, int>> coords;
+        uint32_t first_point;
         char background;
     };
 
@@ -134,12 +144,173 @@ public:
     };
 
     struct Text {
+        StringRef text;
         int orientation;
         int pos_x;
         int pos_y;
         int dimension;
         int unit;
         int convert;
-        char text[255]{};
+    };
+
+    // Pins, rectangles, circles and arcs are stored as parallel arrays (one
+    // per field) so the builders stream through contiguous coordinates. The
+    // structs above are used for a single record while parsing. The arrays
+    // are allocated from the given memory resource (see Legacy).
+
+    struct Pins {
+        std::pmr::memory_resource* resource =
+                std::pmr::get_default_resource();
+        std::pmr::vector<StringRef> name{resource};
+        std::pmr::vector<StringRef> number{resource};
+        std::pmr::vector<StringRef> shape{resource};
+        std::pmr::vector<int> pos_x{resource};
+        std::pmr::vector<int> pos_y{resource};
+        std::pmr::vector<int> length{resource};
+        std::pmr::vector<int> text_num_size{resource};
+        std::pmr::vector<int> text_name_size{resource};
+        std::pmr::vector<int> unit{resource};
+        std::pmr::vector<int> convert{resource};
+        std::pmr::vector<char> orientation{resource};
+        std::pmr::vector<char> electric_type{resource};
+
+        Pins() = default;
+
+        explicit Pins(std::pmr::memory_resource* resource)
+                : resource(resource) {}
+
+        std::size_t size() const { return pos_x.size(); }
+
+        bool empty() const { return pos_x.empty(); }
+
+        void push_back(const Pin& pin) {
+            name.push_back(pin.name);
+            number.push_back(pin.number);
+            shape.push_back(pin.shape);
+            pos_x.push_back(pin.pos_x);
+            pos_y.push_back(pin.pos_y);
+            length.push_back(pin.length);
+            text_num_size.push_back(pin.text_num_size);
+            text_name_size.push_back(pin.text_name_size);
+            unit.push_back(pin.unit);
+            convert.push_back(pin.convert);
+            orientation.push_back(pin.orientation);
+            electric_type.push_back(pin.electric_type);
+        }
+    };
+
+    struct Rectangles {
+        std::pmr::memory_resource* resource =
+                std::pmr::get_default_resource();
+        std::pmr::vector<int> start_x{resource};
+        std::pmr::vector<int> start_y{resource};
+        std::pmr::vector<int> end_x{resource};
+        std::pmr::vector<int> end_y{resource};
+        std::pmr::vector<int> unit{resource};
+        std::pmr::vector<int> convert{resource};
+        std::pmr::vector<int> thickness{resource};
+        std::pmr::vector<char> background{resource};
+
+        Rectangles() = default;
+
+        explicit Rectangles(std::pmr::memory_resource* resource)
+                : resource(resource) {}
+
+        std::size_t size() const { return start_x.size(); }
+
+        bool empty() const { return start_x.empty(); }
+
+        void push_back(const Rectangle& rectangle) {
+            start_x.push_back(rectangle.start_x);
+            start_y.push_back(rectangle.start_y);
+            end_x.push_back(rectangle.end_x);
+            end_y.push_back(rectangle.end_y);
+            unit.push_back(rectangle.unit);
+            convert.push_back(rectangle.convert);
+            thickness.push_back(rectangle.thickness);
+            background.push_back(rectangle.background);
+        }
+    };
+
+    struct Circles {
+        std::pmr::memory_resource* resource =
+                std::pmr::get_default_resource();
+        std::pmr::vector<int> pos_x{resource};
+        std::pmr::vector<int> pos_y{resource};
+        std::pmr::vector<int> radius{resource};
+        std::pmr::vector<int> unit{resource};
+        std::pmr::vector<int> convert{resource};
+        std::pmr::vector<int> thickness{resource};
+        std::pmr::vector<char> background{resource};
+
+        Circles() = default;
+
+        explicit Circles(std::pmr::memory_resource* resource)
+                : resource(resource) {}
+
+        std::size_t size() const { return pos_x.size(); }
+
+        bool empty() const { return pos_x.empty(); }
+
+        void push_back(const Circle& circle) {
+            pos_x.push_back(circle.pos_x);
+            pos_y.push_back(circle.pos_y);
+            radius.push_back(circle.radius);
+            unit.push_back(circle.unit);
+            convert.push_back(circle.convert);
+            thickness.push_back(circle.thickness);
+            background.push_back(circle.background);
+        }
+    };
+
+    struct Arcs {
+        std::pmr::memory_resource* resource =
+                std::pmr::get_default_resource();
+        std::pmr::vector<int> pos_x{resource};
+        std::pmr::vector<int> pos_y{resource};
+        std::pmr::vector<int> radius{resource};
+        std::pmr::vector<int> start_angle{resource};
+        std::pmr::vector<int> end_angle{resource};
+        std::pmr::vector<int> part{resource};
+        std::pmr::vector<int> convert{resource};
+        std::pmr::vector<int> thickness{resource};
+        std::pmr::vector<int> start_point_x{resource};
+        std::pmr::vector<int> start_point_y{resource};
+        std::pmr::vector<int> end_point_x{resource};
+        std::pmr::vector<int> end_point_y{resource};
+        std::pmr::vector<char> background{resource};
+
+        Arcs() = default;
+
+        explicit Arcs(std::pmr::memory_resource* resource)
+                : resource(resource) {}
+
+        std::size_t size() const { return pos_x.size(); }
+
+        bool empty() const { return pos_x.empty(); }
+
+        void push_back(const Arc& arc) {
+            pos_x.push_back(arc.pos_x);
+            pos_y.push_back(arc.pos_y);
+            radius.push_back(arc.radius);
+            start_angle.push_back(arc.start_angle);
+            end_angle.push_back(arc.end_angle);
+            part.push_back(arc.part);
+            convert.push_back(arc.convert);
+            thickness.push_back(arc.thickness);
+            start_point_x.push_back(arc.start_point_x);
+            start_point_y.push_back(arc.start_point_y);
+            end_point_x.push_back(arc.end_point_x);
+            end_point_y.push_back(arc.end_point_y);
+            background.push_back(arc.background);
+        }
     };
 };
+
+// Records are kept small (no fixed size text buffers), a symbol can have
+// thousands of pins
+static_assert(sizeof(Component::StringRef) == 8);
+static_assert(sizeof(Component::Definition) <= 28);
+static_assert(sizeof(Component::Information) <= 40);
+static_assert(sizeof(Component::Pin) <= 56);
+static_assert(sizeof(Component::Text) <= 32);
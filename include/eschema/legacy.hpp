@@ -25,51 +25,107 @@
 #pragma once
 
 #include <iostream>
+#include <istream>
+#include <functional>
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <vector>
-#include <tuple>
 #include <cstdio>
 #include <iterator>
 #include <cstring>
 
+#include "eschema/arena.hpp"
 #include "eschema/component.hpp"
 #include "eschema/config.hpp"
+#include "eschema/scanner.hpp"
 #include "utils.hpp"
 
+// One component (DEF ... ENDDEF) of a legacy library, everything it holds
+// is allocated from one memory resource
+struct LegacyComponent {
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource();
+    Component::Definition def{};
+    std::pmr::vector<Component::Information> info{resource};
+    Component::Pins pins{resource};
+    Component::Rectangles rectangles{resource};
+    std::pmr::vector<Component::Polygon> polygons{resource};
+    std::pmr::vector<int> points{resource}; // x, y pairs of every polygon
+    Component::Circles circles{resource};
+    Component::Arcs arcs{resource};
+    std::pmr::vector<Component::Text> texts{resource};
+
+    // Text of the records above, each NUL terminated (offset 0 is "")
+    std::pmr::string strings{std::pmr::string(1, '\0', resource)};
+
+    LegacyComponent() = default;
+
+    explicit LegacyComponent(std::pmr::memory_resource* resource)
+            : resource(resource) {}
+
+    Component::StringRef add_string(std::string_view value);
+
+    const char* get_string(Component::StringRef ref) const;
+};
+
 class Legacy {
-    static std::vector<std::tuple<int, int>> extract_polygon_coords(
-            const std::string& line, int n_coords);
+    // Components are parsed on at most this many threads
+    static constexpr std::size_t MAX_THREADS = 8;
+
+    // Each thread takes a few chunks of consecutive components
+    static constexpr std::size_t CHUNKS_PER_THREAD = 4;
+
+    static bool next_line(std::string_view contents, std::size_t& pos,
+                          std::string_view& line);
+
+    static std::string_view next_token(std::string_view& rest);
+
+    static std::vector<std::string_view> split_components(
+            std::string_view contents);
+
+    void convert_lines(std::string_view contents);
+
+    bool convert_line(std::string_view line);
+
+    static bool parse_error(const Scanner& scanner, std::string_view line);
+
+    bool in_definition = false; // Between DEF and ENDDEF
+
+    // Components are allocated from arena, which is one of arenas unless it
+    // belongs to another Legacy (one arena per chunk when parsing in parallel)
+    std::vector<std::unique_ptr<Arena>> arenas;
+    Arena* arena;
 
 public:
-    Component::Definition def;
-    std::vector<Component::Information> info;
-    std::vector<Component::Pin> pins;
-    std::vector<Component::Rectangle> rectangles;
-    std::vector<Component::Polygon> polygons;
-    std::vector<Component::Circle> circles;
-    std::vector<Component::Arc> arcs;
-    std::vector<Component::Text> texts;
+    Legacy();
+
+    explicit Legacy(Arena* arena);
+
+    // Every component in the library (in order)
+    std::vector<LegacyComponent> components;
+
+    bool convert(std::string_view contents);
 
-    bool convert(const std::vector<std::string>& lines);
+    bool convert(std::istream& input,
+                 const std::function<bool(LegacyComponent&)>& parsed);
 
-    bool identify(const std::string& token, const std::string& line);
+    bool identify(std::string_view token, std::string_view line);
 
-    bool parse_definition(const std::string& line);
+    bool parse_definition(std::string_view line);
 
-    bool parse_information(const std::string& line);
+    bool parse_information(std::string_view line);
 
-    bool parse_pin(const std::string& line);
+    bool parse_pin(std::string_view line);
 
-    bool parse_rectangle(const std::string& line);
+    bool parse_rectangle(std::string_view line);
 
-    bool parse_polygon(const std::string& line);
+    bool parse_polygon(std::string_view line);
 
-    bool parse_circle(const std::string& line);
+    bool parse_circle(std::string_view line);
 
-    bool parse_arc(const std::string& line);
+    bool parse_arc(std::string_view line);
 
-    bool parse_text(const std::string& line);
+    bool parse_text(std::string_view line);
 
 private:
 
@@ -25,66 +25,88 @@
 #pragma once
 
 #include <iostream>
-#include <cstring>
+#include <cstdint>
 #include <fstream>
+#include <string>
 
 #include "utils.hpp"
 #include "eschema/component.hpp"
 #include "eschema/legacy.hpp"
+#include "eschema/sexpr.hpp"
 
 class Symbol {
-    char buffer[512];
-    static const int AUX_BUF_SIZE = 512;
-    char aux_buffer[AUX_BUF_SIZE];
-    std::string output_filename;
+    std::string output; // Contents of the .kicad_sym file
+    SExpr sexpr{output}; // Writes elements into the output
+    Arena arena; // Scratch memory while building one component
+
+    // Components are built on at most this many threads
+    static constexpr std::size_t MAX_THREADS = 8;
+
+    // Each thread takes a few chunks of consecutive components
+    static constexpr std::size_t CHUNKS_PER_THREAD = 4;
 
     struct PinShape {
-        bool visible = false;
-        std::string shape;
+        bool visible;
+        const char* shape;
         char identifier;
     };
 
 public:
-    bool new_from_legacy(Legacy* legacy_component, const std::string& filename);
+    Symbol() = default;
+
+    // The writer refers to this symbol's output, so a copy or move would
+    // keep writing into the original
+    Symbol(const Symbol&) = delete;
+    Symbol(Symbol&&) = delete;
+    Symbol& operator=(const Symbol&) = delete;
+    Symbol& operator=(Symbol&&) = delete;
+
+    bool render(const Legacy* legacy, std::string& contents);
 
 private:
-    bool write_to_file(const char* contents);
+    bool write_line(const char* contents);
 
     bool build_header();
 
-    bool build_symbol(Legacy* legacy_component);
+    bool build_library(const Legacy* legacy,
+                       std::vector<std::string>& outputs);
+
+    bool build_component(const LegacyComponent* legacy_component);
+
+    bool build_symbol(const LegacyComponent* legacy_component);
+
+    void build_pins_definition(const LegacyComponent* legacy_component);
 
-    const char* build_pins_definition(Legacy* legacy_component);
+    bool build_properties(const LegacyComponent* legacy_component);
 
-    bool build_properties(Legacy* legacy_component);
+    void build_font(double font_size, char bold = 'N', char italic = 'N');
 
-    const char* build_font(int font_size, char bold = 'N',
-                           char italic = 'N');
+    void build_text_justification(const Component::Information* info);
 
-    const char* build_text_justification(const Component::Information* info);
+    static constexpr const char* get_justification(char identifier);
 
-    void add_justification(char identifier);
+    std::pmr::vector<double> to_millimeters(
+            const std::pmr::vector<int>& mils);
 
-    bool build_graphics(Legacy* legacy_component);
+    bool build_graphics(const LegacyComponent* legacy_component);
 
-    bool build_polygons(const std::vector<Component::Polygon>& polygons);
+    bool build_polygons(const LegacyComponent* legacy_component);
 
-    static std::string build_polygon_points(
-            const std::vector<std::tuple<int, int>>& coords);
+    void build_polygon_points(const double* points_mm, int n_points);
 
-    bool build_pins(const Legacy* legacy_component);
+    bool build_pins(const LegacyComponent* legacy_component);
 
-    static PinShape get_pin_shape(const char* shape_buf);
+    static constexpr PinShape get_pin_shape(const char* shape_buf);
 
-    static std::string get_pin_type(char identifier);
+    static constexpr const char* get_pin_type(char identifier);
 
-    static int get_pin_orientation(char identifier);
+    static constexpr int get_pin_orientation(char identifier);
 
-    bool build_circles(const std::vector<Component::Circle>& circles);
+    bool build_circles(const Component::Circles& circles);
 
-    bool build_arcs(const std::vector<Component::Arc>& arcs);
+    bool build_arcs(const Component::Arcs& arcs);
 
-    bool build_rectangles(const std::vector<Component::Rectangle>& rectangles);
+    bool build_rectangles(const Component::Rectangles& rectangles);
 
-    bool build_text_fields(const std::vector<Component::Text>& text_fields);
+    bool build_text_fields(const LegacyComponent* legacy_component);
 };
@@ -0,0 +1,72 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Harvey Bates
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <charconv>
+#include <string_view>
+
+/**
+ * @brief Reads the whitespace separated fields of a legacy (.lib) record in
+ * order, straight from the line (no copies or format strings).
+ *
+ * @note Each method returns false if the next field is missing or malformed,
+ * column() then gives the position of the first field that failed.
+ *
+ * @example
+ * Scanner scanner("S -300 300 300 -300 0 1 10 f");
+ * scanner.skip() && scanner.integer(start_x) && ...
+ */
+class Scanner {
+    std::string_view line;
+    std::size_t pos = 0;
+    std::size_t error_pos = std::string_view::npos;
+
+    void skip_space();
+
+    std::string_view next_field();
+
+    bool fail(std::size_t field_pos);
+
+public:
+    explicit Scanner(std::string_view line);
+
+    bool keyword(std::string_view expected);
+
+    bool skip();
+
+    bool integer(int& value);
+
+    bool character(char& value);
+
+    bool next_character(char& value);
+
+    bool word(std::string_view& value);
+
+    bool quoted(std::string_view& value);
+
+    bool at_end();
+
+    std::size_t column() const;
+};
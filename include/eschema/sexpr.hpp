@@ -0,0 +1,96 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Harvey Bates
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+/**
+ * @brief Number written with a fixed number of decimals, exactly as
+ * printf("%.Nf") would.
+ *
+ * @example
+ * Fixed<3>{1.27} -> 1.270
+ */
+template<int Precision>
+struct Fixed {
+    static_assert(Precision >= 0 && Precision <= 6,
+                  "Fixed supports 0 to 6 decimals");
+
+    double value;
+};
+
+/**
+ * @brief Writes the text of S-expressions straight into a string.
+ *
+ * @note An element is written as a list of parts (text, characters, integers
+ * and Fixed numbers). How each part is written is chosen at compile time
+ * from its type, so there is no format string to parse, no temporary buffer
+ * and no limit on the length of a line.
+ *
+ * @example
+ * SExpr sexpr(output);
+ * sexpr.line("(at ", Fixed<3>{x}, ' ', Fixed<3>{y}, ' ', angle, ")");
+ */
+class SExpr {
+    std::string& out;
+
+    void put(const char* text) { out += text; }
+
+    void put(char character) { out += character; }
+
+    void put(int value);
+
+    template<int Precision>
+    void put(Fixed<Precision> number) {
+        constexpr uint64_t DIVISOR = power_of_ten(Precision);
+        put_fixed(number.value, Precision, DIVISOR);
+    }
+
+    void put_fixed(double value, int precision, uint64_t divisor);
+
+    static constexpr uint64_t power_of_ten(int exponent) {
+        return exponent == 0 ? 1 : 10 * power_of_ten(exponent - 1);
+    }
+
+public:
+    explicit SExpr(std::string& out) : out(out) {}
+
+    // Appends the parts in order
+    template<typename... Parts>
+    void write(const Parts& ... parts) {
+        (put(parts), ...);
+    }
+
+    // Appends the parts in order, then a newline
+    template<typename... Parts>
+    void line(const Parts& ... parts) {
+        (put(parts), ...);
+        out += '\n';
+    }
+};
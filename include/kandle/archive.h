@@ -0,0 +1,139 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Harvey Bates
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef KANDLE_ARCHIVE_H
+#define KANDLE_ARCHIVE_H
+
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <zlib.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "utils.hpp"
+
+namespace Kandle {
+    /**
+     * @brief Minimal in-process reader for .zip files (as supplied by symbol
+     * vendors).
+     *
+     * @note Only stored and deflated members are supported (no encryption
+     * or ZIP64), which covers every vendor download seen so far.
+     *
+     * @note The archive is memory mapped, so locating the central directory
+     * and reading stored members doesn't copy the file.
+     */
+    class Archive {
+    public:
+        Archive() = default;
+
+        Archive(const Archive&) = delete;
+
+        Archive& operator=(const Archive&) = delete;
+
+        ~Archive();
+
+        struct Entry {
+            std::string name;
+            uint16_t method;
+            uint32_t crc32;
+            uint32_t compressed_size;
+            uint32_t uncompressed_size;
+            uint32_t local_header_offset;
+        };
+
+        bool open(const std::string& path);
+
+        bool open_memory(std::string contents);
+
+        bool open_nested(const Entry& entry, Archive& nested) const;
+
+        static bool is_zip(const std::string& path);
+
+        const std::vector<Entry>& entries() const;
+
+        uint64_t checksum() const;
+
+        bool read(const Entry& entry, std::string& contents) const;
+
+        bool read(const std::vector<Entry>& entries,
+                  std::vector<std::string>& contents) const;
+
+        bool extract(const Entry& entry,
+                     const std::string& output_directory) const;
+
+        bool extract(const std::vector<Entry>& entries,
+                     const std::string& output_directory) const;
+
+        bool extract_all(const std::string& output_directory) const;
+
+        static bool is_directory(const Entry& entry);
+
+        static bool is_archive(const Entry& entry);
+
+    private:
+        // Members are inflated on at most this many threads
+        static constexpr std::size_t MAX_THREADS = 4;
+
+        // Archives inside archives inside archives... are not followed
+        static constexpr int MAX_NESTING_DEPTH = 2;
+
+        const char* data = nullptr;
+        std::size_t size = 0;
+        void* mapping = nullptr;
+        std::string buffer; // Contents of a nested archive (not mapped)
+        int depth = 0;
+        std::vector<Entry> members;
+
+        static bool map(const std::string& path, void** region,
+                        std::size_t* length);
+
+        static std::size_t find_end_of_central_directory(const char* start,
+                                                         std::size_t length);
+
+        bool read_central_directory();
+
+        bool inflate_to(const Entry& entry, const char* start,
+                        std::ostream& output) const;
+
+        bool member_data(const Entry& entry, const char** start) const;
+
+        static bool safe_name(const std::string& name);
+
+        static bool for_each_parallel(
+                const std::vector<Entry>& entries,
+                const std::function<bool(std::size_t)>& task);
+    };
+} // namespace Kandle
+
+#endif //KANDLE_ARCHIVE_H
@@ -30,9 +30,16 @@
 #include <string>
 #include <sstream>
 #include <vector>
+#include <set>
+#include <memory>
+#include <optional>
 #include <regex>
+#include <mutex>
+#include <atomic>
 #include "eschema/release.hpp"
 #include "eschema/legacy.hpp"
+#include "kandle/archive.h"
+#include "kandle/tarball.h"
 #include "utils.hpp"
 
 // TODO handle other OS
@@ -42,12 +49,15 @@ namespace Kandle {
 
         static bool validate_zip_file(const std::string& path);
 
-        static std::string convert_symbol(
+        static std::vector<std::string> convert_symbol(
                 const std::string& legacy_symbol_path);
 
-        static bool new_symbol_library(const std::string& path);
+        static bool convert_symbol(const std::string& legacy_contents,
+                                   const std::string& name,
+                                   std::vector<std::string>& lines);
 
-        static bool append_to_symbol_library(const std::string& path);
+        static std::string extraction_stamp(const Archive& archive,
+                                            bool selective);
 
         static void build_library_paths(const std::string& library_name);
 
@@ -61,20 +71,123 @@ namespace Kandle {
             std::string dmodel;
         };
 
+        // Component files read directly from an archive (no tmp directory)
+        struct FileContents {
+            std::string name; // Component name (see build_component_name)
+            std::string symbol_name;
+            std::vector<std::string> symbol;
+            std::vector<std::string> footprint;
+            std::string dmodel;
+            std::string dmodel_extension;
+        };
+
+        enum class MemberType {
+            none,
+            component_root, // Start of a (CSE) KiCad specific directory
+            symbol,
+            legacy_symbol,
+            footprint,
+            dmodel
+        };
+
+        // Picks the first symbol, footprint and 3D model found (in order)
+        struct Selector {
+            bool symbol_found = false;
+            bool footprint_found = false;
+            bool dmodel_found = false;
+
+            MemberType select(const std::filesystem::path& item);
+        };
+
+        struct Member {
+            MemberType type;
+            Archive::Entry entry;
+            const Archive* archive; // Outer or nested archive
+            std::string directory; // Where a nested archive is extracted to
+        };
+
+        struct Selection {
+            std::vector<Member> members;
+            // Nested archives (in memory) that members may refer to
+            std::vector<std::unique_ptr<Archive>> nested;
+        };
+
+        static std::string build_component_name(const std::string& path);
+
         static void constrain_footprint_text(std::string& line);
 
-        static std::string unzip(const std::string& path);
+        static Selection select_members(const Archive& archive);
+
+        static bool read_members(const std::vector<Member>& members,
+                                 std::vector<std::string>& contents);
+
+        static std::string unzip(const std::string& path,
+                                 bool selective = true);
 
         static FilePaths
         recursive_extract_paths(const std::string& library_name);
 
+        static std::optional<FileContents> load(const std::string& path);
+
+        static std::vector<std::optional<FileContents>> load(
+                const std::vector<std::string>& paths);
+
+        static std::optional<FileContents> load_archive(
+                const std::string& path);
+
+        static std::optional<FileContents> load_tarball(
+                const std::string& path);
+
+        static bool import_components(const std::string& library_name,
+                                      std::vector<FileContents>& components);
+
         static bool import_symbol(const std::string& path);
 
+        static bool import_symbol(const std::string& symbol_name,
+                                  std::vector<std::string>& lines);
+
         static void substitute_footprint(std::string& line);
 
         static bool import_footprint(const std::string& path);
 
+        static bool import_footprint(const std::vector<std::string>& lines);
+
         static bool import_3dmodel(const std::string& path);
+
+        static bool import_3dmodel(const std::string& contents,
+                                   const std::string& extension);
+
+    private:
+        // Component files are loaded on at most this many threads
+        static constexpr std::size_t MAX_THREADS = 8;
+
+        // Symbol library held in memory while components are merged into it
+        struct SymbolLibrary {
+            std::vector<std::string> lines;
+            bool exists = false;
+            bool modified = false;
+        };
+
+        static void open_symbol_library(SymbolLibrary& library);
+
+        static bool merge_symbol(SymbolLibrary& library,
+                                 const std::string& symbol_name,
+                                 std::vector<std::string>& lines);
+
+        static bool write_symbol_library(const SymbolLibrary& library);
+
+        static int selection_slot(MemberType type);
+
+        static std::optional<FileContents> build_file_contents(
+                const std::vector<Member>& members,
+                std::vector<std::string>& member_data,
+                const std::string& name);
+
+        static void select_members(
+                const Archive& archive, const std::filesystem::path& prefix,
+                Selector& selector, std::set<std::string>& directories,
+                Member (& selected)[3],
+                std::vector<std::unique_ptr<Archive>>& nested);
     };
 } // namespace Kandle
 
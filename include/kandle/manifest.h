@@ -0,0 +1,76 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Harvey Bates
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef KANDLE_MANIFEST_H
+#define KANDLE_MANIFEST_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Kandle {
+    /**
+     * @brief List of component files and the library each belongs to, used
+     * to import a whole project's worth of components at once.
+     *
+     * @example CSV, one component per line (the header is optional):
+     * file,library
+     * Downloads/ul_LM358-A.zip,opamps
+     *
+     * @example JSON, either a list of components or libraries and their
+     * components:
+     * [{"file": "Downloads/ul_LM358-A.zip", "library": "opamps"}]
+     * {"opamps": ["Downloads/ul_LM358-A.zip", "Downloads/TL072.zip"]}
+     *
+     * @note Relative file paths are relative to the manifest.
+     */
+    class Manifest {
+    public:
+        struct Library {
+            std::string name;
+            std::vector<std::string> files;
+        };
+
+        static bool read(const std::string& path,
+                         std::vector<Library>& libraries);
+
+    private:
+        static bool parse_csv(const std::string& contents,
+                              std::vector<Library>& libraries);
+
+        static bool parse_json(const std::string& text,
+                               std::vector<Library>& libraries);
+
+        static void add(std::vector<Library>& libraries,
+                        const std::string& library, const std::string& file);
+    };
+} // namespace Kandle
+
+#endif //KANDLE_MANIFEST_H
@@ -0,0 +1,91 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Harvey Bates
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef KANDLE_TARBALL_H
+#define KANDLE_TARBALL_H
+
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <zlib.h>
+#include <unistd.h>
+
+namespace Kandle {
+    /**
+     * @brief Forward only reader for .tar.gz/.tgz files. Members are read
+     * in a single pass with no seeking, so the file can be piped in on stdin.
+     *
+     * @note Uncompressed .tar files are also accepted (zlib passes them
+     * through).
+     */
+    class Tarball {
+    public:
+        struct Entry {
+            std::string name;
+            uint64_t size;
+            bool directory;
+        };
+
+        Tarball() = default;
+
+        Tarball(const Tarball&) = delete;
+
+        Tarball& operator=(const Tarball&) = delete;
+
+        ~Tarball();
+
+        bool open(const std::string& path);
+
+        bool next(Entry& entry);
+
+        bool read(std::string& contents);
+
+        static bool is_tarball(const std::string& path);
+
+    private:
+        static const std::size_t BLOCK_SIZE = 512;
+
+        // Members are read into memory in pieces of this size
+        static constexpr std::size_t READ_SIZE = 1 << 20;
+
+        gzFile file = nullptr;
+        uint64_t remaining = 0; // Unread bytes of the current member
+        uint64_t padding = 0; // Padding after the current member
+
+        bool read_block(char* block);
+
+        bool skip(uint64_t length);
+
+        static uint64_t parse_size(const char* field, std::size_t length);
+
+        static bool valid_checksum(const char* block);
+
+        static std::string pax_path(const std::string& records);
+    };
+} // namespace Kandle
+
+#endif //KANDLE_TARBALL_H
@@ -28,18 +28,35 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 class Utils {
 public:
     static std::vector<std::string> readlines(
             const std::string& filename);
 
+    static std::vector<std::string> splitlines(const std::string& contents);
+
+    static uint64_t xxhash64(const char* data, std::size_t length,
+                             uint64_t seed = 0);
+
+    static bool parallel_for(std::size_t count,
+                             const std::function<bool(std::size_t)>& task,
+                             std::size_t max_threads);
+
     static bool assert_true(char c);
 
     static double mils_to_millimeters(int mils);
 
-    static std::string replace_empty_quotes(const std::string& input);
-
-    static std::string split_string_nth_space(const std::string& input,
-                                              int n);
+    static void mils_to_millimeters(const int* mils, double* millimeters,
+                                    std::size_t count);
 };
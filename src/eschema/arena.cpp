@@ -0,0 +1,92 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Harvey Bates
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include "eschema/arena.hpp"
+
+void Arena::add_block(std::size_t size) {
+    // Not value-initialised (make_unique would zero every block)
+    std::unique_ptr<std::byte[]> data(new std::byte[size]);
+    blocks.push_back({std::move(data), size});
+    capacity += size;
+    used = 0;
+}
+
+// Offset of the first suitably aligned byte at or after used
+static std::size_t aligned_offset(const std::byte* data, std::size_t used,
+                                  std::size_t alignment) {
+    auto base = (uintptr_t) data;
+    return ((base + used + alignment - 1) & ~(uintptr_t) (alignment - 1)) -
+           base;
+}
+
+void* Arena::do_allocate(std::size_t bytes, std::size_t alignment) {
+    if (!blocks.empty()) {
+        Block& block = blocks.back();
+        std::size_t offset = aligned_offset(block.data.get(), used, alignment);
+
+        if (offset + bytes <= block.size) {
+            used = offset + bytes;
+            return block.data.get() + offset;
+        }
+    }
+
+    // Blocks double in size (at least), so there are few of them
+    std::size_t size = std::max(MIN_BLOCK_SIZE, bytes + alignment);
+    if (!blocks.empty()) {
+        size = std::max(size, blocks.back().size * 2);
+    }
+    add_block(size);
+
+    std::size_t offset = aligned_offset(blocks.back().data.get(), 0,
+                                        alignment);
+    used = offset + bytes;
+
+    return blocks.back().data.get() + offset;
+}
+
+// Memory is only released by reset()
+void Arena::do_deallocate(void* /*p*/, std::size_t /*bytes*/,
+                          std::size_t /*alignment*/) {
+}
+
+bool Arena::do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+/**
+ * @brief Releases every allocation. If the last use needed more than one
+ * block, they are replaced by a single block of the combined size.
+ */
+void Arena::reset() {
+    if (blocks.size() > 1) {
+        std::size_t size = capacity;
+        blocks.clear();
+        capacity = 0;
+        add_block(size);
+    }
+
+    used = 0;
+}
@@ -24,42 +24,289 @@
 
 #include "eschema/legacy.hpp"
 
-bool Legacy::convert(const std::vector<std::string>& lines) {
+/**
+ * @brief Adds text to the component's string table.
+ *
+ * @param value Text to add.
+ * @return Reference to the text in the table.
+ */
+Component::StringRef LegacyComponent::add_string(std::string_view value) {
+    if (value.empty()) {
+        return {};
+    }
 
-    bool found_definition = false;
+    Component::StringRef ref{(uint32_t) strings.size(),
+                             (uint32_t) value.size()};
+    strings.append(value);
+    strings.push_back('\0');
+
+    return ref;
+}
+
+// Text from the string table (NUL terminated)
+const char* LegacyComponent::get_string(Component::StringRef ref) const {
+    return strings.data() + ref.offset;
+}
+
+Legacy::Legacy() {
+    arenas.push_back(std::make_unique<Arena>());
+    arena = arenas.back().get();
+}
+
+// Components are allocated from an arena owned by the caller
+Legacy::Legacy(Arena* arena) : arena(arena) {}
+
+/**
+ * @brief Parses the contents of a legacy (.lib) file, held in one buffer.
+ *
+ * @note Lines are tokenized in place (no copies), empty lines and comments
+ * (lines beginning with '#') are skipped as Utils::readlines does.
+ *
+ * @note The file is split into components first, which are then parsed in
+ * parallel (large libraries have thousands).
+ *
+ * @param contents Contents of the .lib file.
+ * @return True once every line has been parsed.
+ */
+bool Legacy::convert(std::string_view contents) {
 
     std::cout << "Converting legacy file." << std::endl;
 
-    // Iterate through lines
-    for (const auto& l: lines) {
-        std::stringstream strstr(l);
-        std::istream_iterator<std::string> it(strstr);
-        std::istream_iterator<std::string> end;
-        std::vector<std::string> tokens(it, end);
-
-        // Tokenize the line into its space delimited components
-        if (!found_definition) {
-            for (const auto& t: tokens) {
-                if (t == "DEF") {
-                    parse_definition(l);
-                    found_definition = true;
+    std::vector<std::string_view> blocks = split_components(contents);
+
+    // Consecutive components are parsed in chunks, each chunk on one thread
+    // into its own arena (kept for as long as the components are)
+    std::size_t n_chunks = std::min(blocks.size(),
+                                    MAX_THREADS * CHUNKS_PER_THREAD);
+    std::vector<std::vector<LegacyComponent>> parsed(n_chunks);
+    std::vector<Arena*> chunk_arenas;
+    for (std::size_t i = 0; i < n_chunks; i++) {
+        arenas.push_back(std::make_unique<Arena>());
+        chunk_arenas.push_back(arenas.back().get());
+    }
+
+    bool success = Utils::parallel_for(n_chunks, [&](std::size_t i) {
+        std::size_t begin = i * blocks.size() / n_chunks;
+        std::size_t end = (i + 1) * blocks.size() / n_chunks;
+        Legacy chunk(chunk_arenas[i]);
+
+        for (std::size_t block = begin; block < end; block++) {
+            chunk.in_definition = false;
+            chunk.convert_lines(blocks[block]);
+        }
+
+        // One component per block
+        parsed[i] = std::move(chunk.components);
+        return parsed[i].size() == end - begin;
+    }, MAX_THREADS);
+
+    components.reserve(components.size() + blocks.size());
+    for (auto& chunk: parsed) {
+        for (auto& component: chunk) {
+            components.push_back(std::move(component));
+        }
+    }
+
+    return success;
+}
+
+/**
+ * @brief Parses a legacy (.lib) file one record at a time. Only the current
+ * component is held in memory, each is handed over once complete.
+ *
+ * @note Components are parsed in order on the calling thread (memory stays
+ * bounded by the largest component, not the size of the file). Each one is
+ * allocated from the same arena, reset once it has been handed over.
+ *
+ * @param input Stream of the .lib file.
+ * @param parsed Called with each complete component, returns false to stop.
+ * @return True if the whole file was parsed.
+ */
+bool Legacy::convert(std::istream& input,
+                     const std::function<bool(LegacyComponent&)>& parsed) {
+
+    std::cout << "Converting legacy file." << std::endl;
+
+    std::string line;
+    while (std::getline(input, line)) {
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+
+        convert_line(line);
+
+        // A new DEF (without an ENDDEF) completes the previous component
+        if (components.size() > 1) {
+            if (!parsed(components.front())) {
+                return false;
+            }
+            components.erase(components.begin());
+        }
+
+        // ENDDEF completes the current one (its memory is then reused)
+        if (!in_definition && !components.empty()) {
+            if (!parsed(components.front())) {
+                return false;
+            }
+            components.clear();
+            arena->reset();
+        }
+    }
+
+    // Last component wasn't closed with ENDDEF
+    if (!components.empty()) {
+        if (!parsed(components.front())) {
+            return false;
+        }
+        components.clear();
+        arena->reset();
+    }
+
+    return !input.bad();
+}
+
+// Finds the next line that isn't empty or a comment
+bool Legacy::next_line(std::string_view contents, std::size_t& pos,
+                       std::string_view& line) {
+    while (pos < contents.size()) {
+        std::size_t end = contents.find('\n', pos);
+        if (end == std::string_view::npos) {
+            end = contents.size();
+        }
+
+        line = contents.substr(pos, end - pos);
+        pos = end + 1;
+
+        if (!line.empty() && line.front() != '#') {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Splits a legacy library into its components, using the same rules
+ * as convert_line for where a component starts.
+ *
+ * @param contents Contents of the .lib file.
+ * @return Text of each component, from its DEF line up to the next one.
+ */
+std::vector<std::string_view> Legacy::split_components(
+        std::string_view contents) {
+    std::vector<std::string_view> blocks;
+    std::vector<std::size_t> starts;
+    bool in_component = false;
+
+    std::size_t pos = 0;
+    std::string_view line;
+    while (next_line(contents, pos, line)) {
+        std::string_view rest = line;
+        std::string_view token = next_token(rest);
+        bool starts_component = false;
+
+        if (!in_component) {
+            for (; !token.empty(); token = next_token(rest)) {
+                if (token == "DEF") {
+                    starts_component = true;
                     break;
                 }
             }
+        } else if (token == "ENDDEF") {
+            in_component = false;
         } else {
-            if (!identify(tokens.front(), l)) {
-                std::cout << tokens.front() << std::endl;
-                std::cout << "Parse error" << std::endl;
+            starts_component = token == "DEF";
+        }
+
+        if (starts_component) {
+            starts.push_back((std::size_t) (line.data() - contents.data()));
+            in_component = true;
+        }
+    }
+
+    for (std::size_t i = 0; i < starts.size(); i++) {
+        std::size_t end = i + 1 < starts.size() ? starts[i + 1] :
+                          contents.size();
+        blocks.push_back(contents.substr(starts[i], end - starts[i]));
+    }
+
+    return blocks;
+}
+
+// Parses every line in order (on the calling thread)
+void Legacy::convert_lines(std::string_view contents) {
+    std::size_t pos = 0;
+    std::string_view line;
+
+    while (next_line(contents, pos, line)) {
+        convert_line(line);
+    }
+}
+
+// Splits off the next whitespace delimited token (empty at the end of line)
+std::string_view Legacy::next_token(std::string_view& rest) {
+    const char* whitespace = " \t\r\n\v\f";
+
+    std::size_t start = rest.find_first_not_of(whitespace);
+    if (start == std::string_view::npos) {
+        rest = std::string_view();
+        return rest;
+    }
+
+    std::size_t end = rest.find_first_of(whitespace, start);
+    if (end == std::string_view::npos) {
+        end = rest.size();
+    }
+
+    std::string_view token = rest.substr(start, end - start);
+    rest.remove_prefix(end);
+
+    return token;
+}
+
+bool Legacy::convert_line(std::string_view line) {
+    std::string_view rest = line;
+    std::string_view token = next_token(rest);
+
+    // Blank line (only whitespace)
+    if (token.empty()) {
+        return true;
+    }
+
+    // Only the first token is needed once a definition has been found
+    if (!in_definition) {
+        for (; !token.empty(); token = next_token(rest)) {
+            if (token == "DEF") {
+                components.emplace_back(arena);
+                parse_definition(line);
+                in_definition = true;
+                break;
             }
         }
+        return true;
+    }
+
+    if (token == "ENDDEF") {
+        in_definition = false;
+        return true;
+    }
+
+    // A DEF without an ENDDEF starts the next component
+    if (token == "DEF") {
+        components.emplace_back(arena);
+        return parse_definition(line);
+    }
+
+    if (!identify(token, line)) {
+        std::cout << token << std::endl;
+        std::cout << "Parse error" << std::endl;
+        return false;
     }
 
     return true;
 }
 
-bool Legacy::identify(
-        const std::string& token,
-        const std::string& line) {
+bool Legacy::identify(std::string_view token, std::string_view line) {
 
     // Trying not to parse any tokens that are user input
     if (token.length() > 2) {
@@ -103,40 +350,62 @@ bool Legacy::identify(
     return res;
 }
 
-bool Legacy::parse_definition(const std::string& line) {
-
-    int res = std::sscanf(line.c_str(), "DEF %255s %255s 0 %d %c %c %d %*c %c",
-                          def.name, def.reference, &def.pin_name_offset,
-                          &def.show_pin_number, &def.show_pin_name,
-                          &def.num_units, &def.pwr_cmp);
-
-    if (res != 7) {
-        return false;
+bool Legacy::parse_definition(std::string_view line) {
+    LegacyComponent& component = components.back();
+    Component::Definition& def = component.def;
+    Scanner scanner(line);
+    std::string_view name;
+    std::string_view reference;
+    char units_locked;
+
+    // DEF name reference unused text_offset draw_pinnumber draw_pinname
+    // unit_count units_locked option_flag
+    if (!scanner.keyword("DEF") || !scanner.word(name) ||
+        !scanner.word(reference) ||
+        !scanner.skip() || !scanner.integer(def.pin_name_offset) ||
+        !scanner.character(def.show_pin_number) ||
+        !scanner.character(def.show_pin_name) ||
+        !scanner.integer(def.num_units) ||
+        !scanner.character(units_locked) ||
+        !scanner.character(def.pwr_cmp)) {
+        return parse_error(scanner, line);
     }
 
+    def.name = component.add_string(name);
+    def.reference = component.add_string(reference);
+
     return true;
 }
 
-bool Legacy::parse_information(const std::string& line) {
+bool Legacy::parse_information(std::string_view line) {
+    LegacyComponent& component = components.back();
     Component::Information ci;
+    Scanner scanner(line);
+    std::string_view text;
+    std::string_view field_name;
+
+    if (!scanner.skip() || !scanner.quoted(text) ||
+        !scanner.integer(ci.pos_x) || !scanner.integer(ci.pos_y) ||
+        !scanner.integer(ci.font_size) ||
+        !scanner.character(ci.orientation) ||
+        !scanner.character(ci.visibility) ||
+        !scanner.character(ci.horizontal_justification) ||
+        !scanner.character(ci.vertical_justification) ||
+        !scanner.next_character(ci.italic) ||
+        !scanner.next_character(ci.bold)) {
+        return parse_error(scanner, line);
+    }
 
-    std::string line_cpy = Utils::replace_empty_quotes(line);
-
-    int res =
-            std::sscanf(line_cpy.c_str(),
-                        R"(F%*c "%255[^"]" %d %d %d %c %c %c %c%c%c "%255[^"]")",
-                        ci.text, &ci.pos_x, &ci.pos_y, &ci.font_size,
-                        &ci.orientation,
-                        &ci.visibility, &ci.horizontal_justification,
-                        &ci.vertical_justification,
-                        &ci.italic, &ci.bold, ci.field_name);
+    // Empty fields ("") are given a placeholder
+    ci.text = component.add_string(text.empty() ? "None" : text);
 
-    // Expect at least 10 matches (11 if field name is present)
-    if (res < 10) {
-        return false;
+    // Field name is optional
+    if (!scanner.at_end() && scanner.quoted(field_name)) {
+        ci.field_name = component.add_string(field_name.empty() ? "None" :
+                                             field_name);
     }
 
-    info.push_back(ci);
+    component.info.push_back(ci);
 
     return true;
 }
@@ -145,109 +414,114 @@ bool Legacy::parse_information(const std::string& line) {
 //
 // X TO 1 - 200 0.150 R 40 40 1 1 P
 // X 0 1 0 0 0 R 40 40 1 1 W NC
-bool Legacy::parse_pin(const std::string& line) {
-    Component::Pin pin;
-
-    int res = std::sscanf(line.c_str(),
-                          "X %255s %4s %d %d %d %c %d %d %d %d %c %3s",
-                          pin.name, pin.number, &pin.pos_x, &pin.pos_y,
-                          &pin.length,
-                          &pin.orientation, &pin.text_num_size,
-                          &pin.text_name_size,
-                          &pin.unit, &pin.convert, &pin.electric_type,
-                          pin.shape);
-
-    if (res < 10) {
-        if (strlen(pin.name) != 0) {
-            return false;
+bool Legacy::parse_pin(std::string_view line) {
+    LegacyComponent& component = components.back();
+    Component::Pin pin{};
+    Scanner scanner(line);
+    std::string_view name;
+    std::string_view number;
+    std::string_view shape;
+
+    bool parsed = scanner.skip() && scanner.word(name) &&
+                  scanner.word(number) &&
+                  scanner.integer(pin.pos_x) && scanner.integer(pin.pos_y) &&
+                  scanner.integer(pin.length) &&
+                  scanner.character(pin.orientation) &&
+                  scanner.integer(pin.text_num_size) &&
+                  scanner.integer(pin.text_name_size) &&
+                  scanner.integer(pin.unit) && scanner.integer(pin.convert);
+
+    if (!parsed) {
+        if (!name.empty()) {
+            return parse_error(scanner, line);
         }
+    } else if (scanner.character(pin.electric_type) && !scanner.at_end()) {
+        // Shape is optional
+        scanner.word(shape);
     }
 
-    pins.push_back(pin);
+    pin.name = component.add_string(name);
+    pin.number = component.add_string(number);
+    pin.shape = component.add_string(shape);
+
+    component.pins.push_back(pin);
 
     return true;
 }
 
 // Example:
 // S 0 50.900.900 0 1 0 f
-bool Legacy::parse_rectangle(const std::string& line) {
-
+bool Legacy::parse_rectangle(std::string_view line) {
     Component::Rectangle rect{};
-
-    int res = std::sscanf(line.c_str(), "S %d %d %d %d %d %d %d %c",
-                          &rect.start_x, &rect.start_y, &rect.end_x,
-                          &rect.end_y,
-                          &rect.unit, &rect.convert,
-                          &rect.thickness, &rect.background);
-
-    if (res != 8) {
-        return false;
+    Scanner scanner(line);
+
+    if (!scanner.skip() || !scanner.integer(rect.start_x) ||
+        !scanner.integer(rect.start_y) || !scanner.integer(rect.end_x) ||
+        !scanner.integer(rect.end_y) || !scanner.integer(rect.unit) ||
+        !scanner.integer(rect.convert) || !scanner.integer(rect.thickness) ||
+        !scanner.character(rect.background)) {
+        return parse_error(scanner, line);
     }
 
-    rectangles.push_back(rect);
+    components.back().rectangles.push_back(rect);
 
     return true;
 }
 
-std::vector<std::tuple<int, int>> Legacy::extract_polygon_coords(
-        const std::string& line, const int n_coords) {
-
-    std::vector<std::tuple<int, int>> coords;
-    std::stringstream ss(line);
-
-    for (int i = 0; i < n_coords; i++) {
-        int x, y;
-        ss >> x >> y;
-        coords.emplace_back(x, y);
-    }
-
-    return coords;
-}
-
-
 //Example:
 //
 // P 3 0 1 0 -50 50 50 0 -50 -50 F
 // P 2 0 1 0 50 50 50 –50 N
 //
-bool Legacy::parse_polygon(const std::string& line) {
+bool Legacy::parse_polygon(std::string_view line) {
     Component::Polygon polygon{};
+    Scanner scanner(line);
 
     // Get polygon details
-    int res = std::sscanf(line.c_str(), "P %d %d %d %d", &polygon.n_points,
-                          &polygon.parts, &polygon.convert, &polygon.thickness);
-
-    if (res != 4) {
-        return false;
+    if (!scanner.skip() || !scanner.integer(polygon.n_points) ||
+        !scanner.integer(polygon.parts) || !scanner.integer(polygon.convert) ||
+        !scanner.integer(polygon.thickness)) {
+        return parse_error(scanner, line);
     }
 
-    // Split after the polygon details (still has trailing background char)
-    std::string coords_only = Utils::split_string_nth_space(line, 5);
+    // The x, y coords of each point go on the end of the component's points
+    std::pmr::vector<int>& points = components.back().points;
+    std::size_t start = points.size();
+    polygon.first_point = (uint32_t) (start / 2);
 
-    // Get the x, y coords of each part of the polygon
-    polygon.coords = extract_polygon_coords(coords_only, polygon.n_points);
+    for (int i = 0; i < polygon.n_points; i++) {
+        int x, y;
+        if (!scanner.integer(x) || !scanner.integer(y)) {
+            points.resize(start);
+            return parse_error(scanner, line);
+        }
+        points.push_back(x);
+        points.push_back(y);
+    }
 
-    // Last char is the background identifier
-    polygon.background = line[-1];
+    // Background identifier (optional, transparent if missing)
+    if (!scanner.character(polygon.background)) {
+        polygon.background = 'N';
+    }
 
-    polygons.push_back(polygon);
+    components.back().polygons.push_back(polygon);
 
     return true;
 }
 
-bool Legacy::parse_circle(const std::string& line) {
+bool Legacy::parse_circle(std::string_view line) {
     Component::Circle circle{};
-
-    int res = sscanf(line.c_str(), "C %d %d %d %d %d %d %c",
-                     &circle.pos_x, &circle.pos_y, &circle.radius, &circle.unit,
-                     &circle.convert,
-                     &circle.thickness, &circle.background);
-
-    if (res != 7) {
-        return false;
+    Scanner scanner(line);
+
+    if (!scanner.skip() || !scanner.integer(circle.pos_x) ||
+        !scanner.integer(circle.pos_y) || !scanner.integer(circle.radius) ||
+        !scanner.integer(circle.unit) || !scanner.integer(circle.convert) ||
+        !scanner.integer(circle.thickness) ||
+        !scanner.character(circle.background)) {
+        return parse_error(scanner, line);
     }
 
-    circles.push_back(circle);
+    components.back().circles.push_back(circle);
 
     return true;
 }
@@ -256,39 +530,52 @@ bool Legacy::parse_circle(const std::string& line) {
 // Example:
 //
 // A -1 -200 49 900 -11 0 1 0 N -50 -200 0 -150 
-bool Legacy::parse_arc(const std::string& line) {
+bool Legacy::parse_arc(std::string_view line) {
     Component::Arc arc{};
-
-    int res = sscanf(line.c_str(),
-                     "A %d %d %d %d %d %d %d %d %c %d %d %d %d",
-                     &arc.pos_x, &arc.pos_y, &arc.radius, &arc.start_angle,
-                     &arc.end_angle, &arc.part, &arc.convert, &arc.thickness,
-                     &arc.background, &arc.start_point_x, &arc.start_point_y,
-                     &arc.end_point_x, &arc.end_point_y);
-
-    if (res != 13) {
-        return false;
+    Scanner scanner(line);
+
+    if (!scanner.skip() || !scanner.integer(arc.pos_x) ||
+        !scanner.integer(arc.pos_y) || !scanner.integer(arc.radius) ||
+        !scanner.integer(arc.start_angle) || !scanner.integer(arc.end_angle) ||
+        !scanner.integer(arc.part) || !scanner.integer(arc.convert) ||
+        !scanner.integer(arc.thickness) ||
+        !scanner.character(arc.background) ||
+        !scanner.integer(arc.start_point_x) ||
+        !scanner.integer(arc.start_point_y) ||
+        !scanner.integer(arc.end_point_x) ||
+        !scanner.integer(arc.end_point_y)) {
+        return parse_error(scanner, line);
     }
 
-    arcs.push_back(arc);
+    components.back().arcs.push_back(arc);
 
     return true;
 }
 
-bool Legacy::parse_text(const std::string& line) {
+bool Legacy::parse_text(std::string_view line) {
+    LegacyComponent& component = components.back();
     Component::Text t{};
-
-    int res = sscanf(line.c_str(),
-                     "T %d %d %d %d %d %d %50s",
-                     &t.orientation, &t.pos_x, &t.pos_y, &t.dimension,
-                     &t.unit, &t.convert, t.text);
-
-    if (res != 7) {
-        return false;
+    Scanner scanner(line);
+    std::string_view text;
+
+    if (!scanner.skip() || !scanner.integer(t.orientation) ||
+        !scanner.integer(t.pos_x) || !scanner.integer(t.pos_y) ||
+        !scanner.integer(t.dimension) || !scanner.integer(t.unit) ||
+        !scanner.integer(t.convert) || !scanner.word(text)) {
+        return parse_error(scanner, line);
     }
 
-    texts.push_back(t);
+    t.text = component.add_string(text);
+    component.texts.push_back(t);
 
     return true;
 }
 
+// Reports which field of a record couldn't be read
+bool Legacy::parse_error(const Scanner& scanner, std::string_view line) {
+    std::cout << "Unexpected field at column " << scanner.column() << ": "
+              << line << std::endl;
+
+    return false;
+}
+
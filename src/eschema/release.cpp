@@ -24,19 +24,146 @@
 
 #include "eschema/release.hpp"
 
-bool Symbol::new_from_legacy(Legacy* legacy_component,
-                             const std::string& filename) {
-    output_filename = filename;
+// Pin electrical types (legacy identifier -> KiCad 6 keyword)
+struct PinTypeName {
+    char identifier;
+    const char* name;
+};
+
+static constexpr PinTypeName PIN_TYPES[] = {
+        {Component::PinElectricalType::INPUT,          "input"},
+        {Component::PinElectricalType::OUTPUT,         "output"},
+        {Component::PinElectricalType::BIDIRECTIONAL,  "bidirectional"},
+        {Component::PinElectricalType::TRI_STATE,      "tri_state"},
+        {Component::PinElectricalType::PASSIVE,        "passive"},
+        {Component::PinElectricalType::POWER_INPUT,    "power_in"},
+        {Component::PinElectricalType::POWER_OUTPUT,   "power_out"},
+        {Component::PinElectricalType::OPEN_COLLECTOR, "open_collector"},
+        {Component::PinElectricalType::OPEN_EMITTER,   "open_emitter"},
+        {Component::PinElectricalType::NOT_CONNECTED,  "free"},
+        {Component::PinElectricalType::UNSPECIFIED,    "unspecified"},
+};
+
+// Pin shapes, a modifier of '\0' matches any (first match wins)
+struct PinShapeName {
+    char identifier;
+    char modifier;
+    const char* name;
+};
+
+static constexpr PinShapeName PIN_SHAPES[] = {
+        {'I', '\0', "inverted"},
+        {'C', 'I',  "inverted_clock"},
+        {'C', 'L',  "clock_low"},
+        {'C', '\0', "clock"},
+        {'L', '\0', "input_low"},
+        {'V', '\0', "output_low"},
+        {'F', '\0', "edge_clock_high"},
+        {'X', '\0', "non_logic"},
+};
+
+// Pin orientations (direction the pin points -> angle)
+struct PinOrientation {
+    char identifier;
+    int angle;
+};
+
+static constexpr PinOrientation PIN_ORIENTATIONS[] = {
+        {'U', 90},
+        {'D', 270},
+        {'R', 0},
+        {'L', 180},
+};
+
+// Text justification (legacy identifier -> KiCad 6 keyword)
+struct Justification {
+    char identifier;
+    const char* name;
+};
+
+static constexpr Justification JUSTIFICATIONS[] = {
+        {'L', "left"},
+        {'R', "right"},
+        {'B', "bottom"},
+        {'T', "top"},
+};
+
+/**
+ * @brief Converts every component of a legacy library into the contents of
+ * a .kicad_sym file, held in memory (nothing is written to disk).
+ *
+ * @param legacy Parsed legacy library.
+ * @param contents Contents of the .kicad_sym file.
+ * @return True if every component was converted.
+ */
+bool Symbol::render(const Legacy* legacy, std::string& contents) {
+    std::vector<std::string> outputs;
+
+    if (!build_library(legacy, outputs)) {
+        return false;
+    }
+
+    std::size_t size = output.size() + 2;
+    for (const auto& chunk_output: outputs) {
+        size += chunk_output.size();
+    }
 
-    // Clear file contents
-    std::ofstream file(filename, std::ios::out | std::ios::trunc);
-    file.close();
+    contents.clear();
+    contents.reserve(size);
+    contents += output;
+    for (const auto& chunk_output: outputs) {
+        contents += chunk_output;
+    }
+    contents += ")\n";
+
+    return true;
+}
+
+/**
+ * @brief Builds the header into the output and every component into
+ * outputs, the closing bracket is left to the caller.
+ *
+ * @note Consecutive components are built in chunks, each chunk on one thread
+ * into its own output (reusing one arena). Outputs are in component order.
+ *
+ * @param legacy Parsed legacy library.
+ * @param outputs Output of each chunk.
+ * @return True if every component was built.
+ */
+bool Symbol::build_library(const Legacy* legacy,
+                           std::vector<std::string>& outputs) {
+    output.clear();
 
-    // Each of these methods write to a file (filename)
     if (!build_header()) {
         std::cout << "Error building symbol header" << std::endl;
         return false;
     }
+
+    const auto& components = legacy->components;
+    std::size_t n_chunks = std::min(components.size(),
+                                    MAX_THREADS * CHUNKS_PER_THREAD);
+    outputs.assign(n_chunks, std::string());
+
+    return Utils::parallel_for(n_chunks, [&](std::size_t i) {
+        std::size_t begin = i * components.size() / n_chunks;
+        std::size_t end = (i + 1) * components.size() / n_chunks;
+        Symbol symbol;
+
+        for (std::size_t component = begin; component < end; component++) {
+            if (!symbol.build_component(&components[component])) {
+                return false;
+            }
+        }
+
+        outputs[i] = std::move(symbol.output);
+        return true;
+    }, MAX_THREADS);
+}
+
+bool Symbol::build_component(const LegacyComponent* legacy_component) {
+    // Scratch memory of the previous component is reused
+    arena.reset();
+
     if (!build_symbol(legacy_component)) {
         std::cout << "Error building symbol" << std::endl;
         return false;
@@ -50,25 +177,14 @@ bool Symbol::new_from_legacy(Legacy* legacy_component,
         return false;
     }
 
-    if (!write_to_file("  )\n)")) {
-        std::cerr << "Unable to write to converted file." << std::endl;
-        return false;
-    }
-
-    return true;
+    // Closing bracket - end of symbol
+    return write_line("  )");
 }
 
-bool Symbol::write_to_file(const char* contents) {
-
-    std::fstream symbolFile(output_filename,
-                            std::fstream::out | std::fstream::app);
-
-    if (symbolFile.is_open()) {
-        symbolFile << contents << "\n";
-        symbolFile.close();
-    } else {
-        return false;
-    }
+// Appends a line to the output
+bool Symbol::write_line(const char* contents) {
+    output += contents;
+    output += '\n';
 
     return true;
 }
@@ -85,16 +201,14 @@ bool Symbol::write_to_file(const char* contents) {
  * )
  */
 bool Symbol::build_header() {
-    memset(buffer, 0, sizeof(buffer));
     const char* KICAD_VERSION = "20211014";
     const char* KICAD_GENERATOR = "kicad_symbol_editor";
 
     // Note, closing bracket is added at a later stage
-    snprintf(buffer, sizeof(buffer), "(kicad_symbol_lib "
-                                     "(version %s) (generator %s)",
-             KICAD_VERSION, KICAD_GENERATOR);
+    sexpr.line("(kicad_symbol_lib (version ", KICAD_VERSION,
+               ") (generator ", KICAD_GENERATOR, ")");
 
-    return write_to_file(buffer);
+    return true;
 }
 
 
@@ -113,17 +227,14 @@ bool Symbol::build_header() {
  *   [(unit_name "UNIT_NAME")]
  * )
  */
-bool Symbol::build_symbol(Legacy* legacy_component) {
-    char pin_buf[AUX_BUF_SIZE]{};
-    memset(buffer, 0, sizeof(buffer));
-    memcpy(pin_buf, build_pins_definition(legacy_component),
-           sizeof(pin_buf));
+bool Symbol::build_symbol(const LegacyComponent* legacy_component) {
+    sexpr.write("  (symbol \"",
+                legacy_component->get_string(legacy_component->def.name),
+                "\" ");
+    build_pins_definition(legacy_component);
+    sexpr.line(" (in_bom yes) (on_board yes)");
 
-    snprintf(buffer, sizeof(buffer),
-             "  (symbol \"%s\" %s (in_bom yes) (on_board yes)",
-             legacy_component->def.name, pin_buf);
-
-    return write_to_file(buffer);
+    return true;
 }
 
 /**
@@ -132,30 +243,18 @@ bool Symbol::build_symbol(Legacy* legacy_component) {
  *   [(pin_names [(offset OFFSET)] hide)]
  *
  * @param legacy_component
- * @return
  */
-const char* Symbol::build_pins_definition(Legacy* legacy_component) {
-    char buf[40]{};
-
-    memset(aux_buffer, 0, sizeof(aux_buffer));
-
+void Symbol::build_pins_definition(const LegacyComponent* legacy_component) {
     if (!Utils::assert_true(legacy_component->def.show_pin_number)) {
-        strncat(aux_buffer, "(pin_numbers hide) ",
-                sizeof(aux_buffer) - strlen(aux_buffer) - 1);
+        sexpr.write("(pin_numbers hide) ");
     }
 
     double offset = Utils::mils_to_millimeters(
             legacy_component->def.pin_name_offset);
 
-    if (Utils::assert_true(legacy_component->def.show_pin_name)) {
-        snprintf(buf, sizeof(buf), "(pin_names (offset %.3f))", offset);
-        strncat(aux_buffer, buf, sizeof(aux_buffer) - strlen(aux_buffer) - 1);
-    } else {
-        snprintf(buf, sizeof(buf), "(pin_names (offset %.3f) hide)", offset);
-        strncat(aux_buffer, buf, sizeof(aux_buffer) - strlen(aux_buffer) - 1);
-    }
-
-    return aux_buffer;
+    sexpr.write("(pin_names (offset ", Fixed<3>{offset},
+                Utils::assert_true(legacy_component->def.show_pin_name)
+                ? "))" : ") hide)");
 }
 
 
@@ -172,10 +271,8 @@ const char* Symbol::build_pins_definition(Legacy* legacy_component) {
  * @param legacy_component
  * @return
  */
-bool Symbol::build_properties(Legacy* legacy_component) {
+bool Symbol::build_properties(const LegacyComponent* legacy_component) {
     double pos_x, pos_y;
-    char font_buf[AUX_BUF_SIZE];
-    char justify_buf[AUX_BUF_SIZE];
     const char* key;
 
     // Inbuilt keys (in order)
@@ -183,42 +280,37 @@ bool Symbol::build_properties(Legacy* legacy_component) {
     const char* keys[N_INBUILT_KEYS] = {"Reference", "Value", "Footprint",
                                         "Datasheet"};
 
-    int i = 0;
+    // Position and font size of every field, converted in one pass
+    std::pmr::vector<int> values(&arena);
+    values.reserve(legacy_component->info.size() * 3);
     for (const auto& info: legacy_component->info) {
-        memset(buffer, 0, sizeof(buffer));
+        values.push_back(info.pos_x);
+        values.push_back(info.pos_y);
+        values.push_back(info.font_size);
+    }
+    std::pmr::vector<double> values_mm = to_millimeters(values);
 
+    int i = 0;
+    for (const auto& info: legacy_component->info) {
         // Assign the key from either the 4 inbuilt keys or a special key
         if (i < N_INBUILT_KEYS) {
             key = keys[i];
         } else {
-            key = info.field_name;
+            key = legacy_component->get_string(info.field_name);
         }
 
-        pos_x = Utils::mils_to_millimeters(info.pos_x);
-        pos_y = Utils::mils_to_millimeters(info.pos_y);
-
-        // Get font information
-        memcpy(font_buf, build_font(info.font_size,
-                                    info.bold, info.italic), sizeof(font_buf));
-        // Get font justification
-        memcpy(justify_buf, build_text_justification(&info),
-               sizeof(justify_buf));
-
-        snprintf(buffer, sizeof(buffer),
-                 "    (property \"%s\" \"%s\" (id %d) (at %.2f %.2f 0)\n"
-                 "      (effects %s %s",
-                 key, info.text, i, pos_x, pos_y, font_buf, justify_buf);
+        pos_x = values_mm[3 * i];
+        pos_y = values_mm[3 * i + 1];
 
-        if (info.visibility == 'V') {
-            strncat(buffer, ")\n    )", sizeof(buffer) - strlen(buffer) - 1);
-        } else {
-            strncat(buffer, " hide)\n    )",
-                    sizeof(buffer) - strlen(buffer) - 1);
-        }
-
-        if (!write_to_file(buffer)) {
-            return false;
-        }
+        sexpr.write("    (property \"", key, "\" \"",
+                    legacy_component->get_string(info.text), "\" (id ", i,
+                    ") (at ", Fixed<2>{pos_x}, ' ', Fixed<2>{pos_y}, " 0)\n"
+                    "      (effects ");
+        build_font(values_mm[3 * i + 2], info.bold, info.italic);
+        sexpr.write(' ');
+        build_text_justification(&info);
+        sexpr.line(info.visibility == 'V' ? ")" : " hide)", "\n"
+                   "    )");
 
         i++;
     }
@@ -239,32 +331,25 @@ bool Symbol::build_properties(Legacy* legacy_component) {
  *    [(line_spacing LINE_SPACING)]
  *  )
  *
- * @param info
- * @return
+ * @param font_size Font size in millimeters (converted by the caller with
+ * the rest of its column).
+ * @param bold
+ * @param italic
  */
-const char* Symbol::build_font(const int font_size,
-                               const char bold,
-                               const char italic) {
-    double font_size_f = Utils::mils_to_millimeters(font_size);
-
-    memset(aux_buffer, 0, sizeof(aux_buffer));
-
-    snprintf(aux_buffer, sizeof(aux_buffer), "(font (size %.3f %.3f)",
-             font_size_f, font_size_f);
+void Symbol::build_font(const double font_size, const char bold,
+                        const char italic) {
+    sexpr.write("(font (size ", Fixed<3>{font_size}, ' ',
+                Fixed<3>{font_size}, ")");
 
     if (bold == 'B') {
-        strncat(aux_buffer, " bold",
-                sizeof(aux_buffer) - strlen(aux_buffer) - 1);
+        sexpr.write(" bold");
     }
 
     if (italic == 'I') {
-        strncat(aux_buffer, " italic",
-                sizeof(aux_buffer) - strlen(aux_buffer) - 1);
+        sexpr.write(" italic");
     }
 
-    strncat(aux_buffer, ")", sizeof(aux_buffer) - strlen(aux_buffer) - 1);
-
-    return aux_buffer;
+    sexpr.write(")");
 }
 
 /**
@@ -274,68 +359,54 @@ const char* Symbol::build_font(const int font_size,
  * [(justify [left | right] [top | bottom] [mirror])]
  *
  * @param info
- * @return
  */
-const char* Symbol::build_text_justification(
-        const Component::Information* info) {
-    memset(aux_buffer, 0, sizeof(aux_buffer));
-
+void Symbol::build_text_justification(const Component::Information* info) {
     if (info->horizontal_justification != 'C') {
-        strncat(aux_buffer, "(justify ",
-                sizeof(aux_buffer) - strlen(aux_buffer) - 1);
-        add_justification(info->horizontal_justification);
-        strncat(aux_buffer, " ", sizeof(aux_buffer) - strlen(aux_buffer) - 1);
-        add_justification(info->vertical_justification);
-        strncat(aux_buffer, ")", sizeof(aux_buffer) - strlen(aux_buffer) - 1);
+        sexpr.write("(justify ",
+                    get_justification(info->horizontal_justification), ' ',
+                    get_justification(info->vertical_justification), ")");
     }
-
-    return aux_buffer;
 }
 
 /**
  * @brief Used to get the horizontal or vertical justification of text.
- * @warning This appends to the aux buffer in the background.
  *
  * @param identifier Character describing horizontal or vertical justification.
+ * @return Justification keyword (empty if not known, e.g. centred).
  */
-void Symbol::add_justification(char identifier) {
-    switch (identifier) {
-        case 'L':
-            strncat(aux_buffer, "left",
-                    sizeof(aux_buffer) - strlen(aux_buffer) - 1);
-            break;
-        case 'R':
-            strncat(aux_buffer, "right",
-                    sizeof(aux_buffer) - strlen(aux_buffer) - 1);
-            break;
-        case 'B':
-            strncat(aux_buffer, "bottom",
-                    sizeof(aux_buffer) - strlen(aux_buffer) - 1);
-            break;
-        case 'T':
-            strncat(aux_buffer, "top",
-                    sizeof(aux_buffer) - strlen(aux_buffer) - 1);
-            break;
-        default:
-            return;
+constexpr const char* Symbol::get_justification(char identifier) {
+    for (const auto& justification: JUSTIFICATIONS) {
+        if (justification.identifier == identifier) {
+            return justification.name;
+        }
     }
-}
 
+    return "";
+}
 
-bool Symbol::build_graphics(Legacy* legacy_component) {
-    memset(buffer, 0, sizeof(buffer));
 
-    snprintf(buffer, sizeof(buffer), "    (symbol \"%s_0_0\"",
-             legacy_component->def.name);
+/**
+ * @brief Converts a column of mils to millimeters in one batch.
+ *
+ * @param mils Values to convert.
+ * @return Converted values (allocated from the arena).
+ */
+std::pmr::vector<double> Symbol::to_millimeters(
+        const std::pmr::vector<int>& mils) {
+    std::pmr::vector<double> millimeters(mils.size(), &arena);
+    Utils::mils_to_millimeters(mils.data(), millimeters.data(), mils.size());
+    return millimeters;
+}
 
+bool Symbol::build_graphics(const LegacyComponent* legacy_component) {
     // Start of graphics section
-    if (!write_to_file(buffer)) {
-        return false;
-    }
+    sexpr.line("    (symbol \"",
+               legacy_component->get_string(legacy_component->def.name),
+               "_0_0\"");
 
     // Polygons
     if (!legacy_component->polygons.empty()) {
-        if (!build_polygons(legacy_component->polygons)) {
+        if (!build_polygons(legacy_component)) {
             return false;
         }
     }
@@ -363,7 +434,7 @@ bool Symbol::build_graphics(Legacy* legacy_component) {
 
     // Text fields
     if (!legacy_component->texts.empty()) {
-        if (!build_text_fields(legacy_component->texts)) {
+        if (!build_text_fields(legacy_component)) {
             return false;
         }
     }
@@ -375,28 +446,24 @@ bool Symbol::build_graphics(Legacy* legacy_component) {
     }
 
     // Closing bracket - end of graphics section
-    if (!write_to_file("    )")) {
+    if (!write_line("    )")) {
         return false;
     }
 
     return true;
 }
 
-std::string Symbol::build_polygon_points(
-        const std::vector<std::tuple<int, int>>& coords) {
-    double x, y;
-    std::string ret;
-    char buf[50];
-
-    for (const auto& c: coords) {
-        memset(buf, 0, sizeof(buf));
-        x = Utils::mils_to_millimeters(std::get<0>(c));
-        y = Utils::mils_to_millimeters(std::get<1>(c));
-        snprintf(buf, sizeof(buf), "          (xy %.3f %.3f)\n", x, y);
-        ret += buf;
+/**
+ * @brief Writes the (xy X Y) list of a polygon straight to the output.
+ *
+ * @param points_mm x, y pairs already in millimeters.
+ * @param n_points Number of pairs.
+ */
+void Symbol::build_polygon_points(const double* points_mm, int n_points) {
+    for (int i = 0; i < n_points; i++) {
+        sexpr.line("          (xy ", Fixed<3>{points_mm[2 * i]}, ' ',
+                   Fixed<3>{points_mm[2 * i + 1]}, ")");
     }
-
-    return ret;
 }
 
 /**
@@ -409,19 +476,33 @@ std::string Symbol::build_polygon_points(
  *   FILL_DEFINITION
  * )
  *
- * @param polygons
+ * @param legacy_component
  * @return
  */
-bool Symbol::build_polygons(const std::vector<Component::Polygon>& polygons) {
+bool Symbol::build_polygons(const LegacyComponent* legacy_component) {
     double stroke_width;
-    std::string fill;
-    std::string polygon_pts;
+    const char* fill;
 
-    for (const auto& polygon: polygons) {
-        memset(aux_buffer, 0, sizeof(aux_buffer));
+    // Every point of every polygon, converted in one pass
+    std::pmr::vector<double> points_mm =
+            to_millimeters(legacy_component->points);
+
+    // As is the stroke width of every polygon
+    std::pmr::vector<int> thickness(&arena);
+    thickness.reserve(legacy_component->polygons.size());
+    for (const auto& polygon: legacy_component->polygons) {
+        thickness.push_back(polygon.thickness);
+    }
+    std::pmr::vector<double> thickness_mm = to_millimeters(thickness);
 
-        polygon_pts = build_polygon_points(polygon.coords);
-        stroke_width = Utils::mils_to_millimeters(polygon.thickness);
+    std::size_t i = 0;
+    for (const auto& polygon: legacy_component->polygons) {
+        write_line("      (polyline\n"
+                   "        (pts");
+        build_polygon_points(
+                points_mm.data() + 2 * (std::size_t) polygon.first_point,
+                polygon.n_points);
+        stroke_width = thickness_mm[i++];
 
         switch (polygon.background) {
             case 'F':
@@ -434,121 +515,82 @@ bool Symbol::build_polygons(const std::vector<Component::Polygon>& polygons) {
                 break;
         }
 
-        snprintf(aux_buffer,
-                 sizeof(aux_buffer),
-                 "      (polyline\n"
-                 "        (pts\n"
-                 "%s"
-                 "        )\n"
-                 "        (stroke (width %.3f) (type default))\n"
-                 "        (fill (type %s))\n"
-                 "      )",
-                 polygon_pts.c_str(), stroke_width, fill.c_str());
-
-        // Write polygon to file
-        if (!write_to_file(aux_buffer)) {
-            return false;
-        }
+        sexpr.line("        )\n"
+                   "        (stroke (width ", Fixed<3>{stroke_width},
+                   ") (type default))\n"
+                   "        (fill (type ", fill, "))\n"
+                   "      )");
     }
 
     return true;
 }
 
-bool Symbol::build_pins(const Legacy* legacy_component) {
-    double pos_x, pos_y;
-    std::string pin_type;
-    int orientation;
-    double length;
-    PinShape pin_shape;
-    char font_name_buf[128];
-    char font_num_buf[128];
-
-    for (const auto& pin: legacy_component->pins) {
-        memset(buffer, 0, sizeof(buffer));
-        memset(font_name_buf, 0, sizeof(font_num_buf));
-        memset(font_num_buf, 0, sizeof(font_num_buf));
-
-        pin_type = get_pin_type(pin.electric_type);
-        pin_shape = get_pin_shape(pin.shape);
-
-        pos_x = Utils::mils_to_millimeters(pin.pos_x);
-        pos_y = Utils::mils_to_millimeters(pin.pos_y);
-        orientation = get_pin_orientation(pin.orientation);
-        length = Utils::mils_to_millimeters(pin.length);
-
-        memcpy(font_name_buf, build_font(pin.text_name_size),
-               sizeof(font_name_buf));
-
-        memcpy(font_num_buf, build_font(pin.text_num_size),
-               sizeof(font_num_buf));
-
-        snprintf(buffer, sizeof(buffer),
-                 "      (pin %s %s (at %.3f %.3f %d) (length %.3f)\n"
-                 "        (name \"%s\" (effects %s))\n"
-                 "        (number \"%s\" (effects %s))\n"
-                 "      )",
-                 pin_type.c_str(), pin_shape.shape.c_str(),
-                 pos_x, pos_y, orientation, length, pin.name,
-                 font_name_buf, pin.number, font_num_buf);
-
-        if (!write_to_file(buffer)) {
-            return false;
-        }
+/**
+ * @brief Adds the pins of a legacy component, each written in one pass
+ * straight into the output.
+ *
+ * @example
+ * (pin
+ *   PIN_ELECTRICAL_TYPE
+ *   PIN_GRAPHIC_STYLE
+ *   POSITION_IDENTIFIER
+ *   (length LENGTH)
+ *   (name "NAME" TEXT_EFFECTS)
+ *   (number "NUMBER" TEXT_EFFECTS)
+ * )
+ *
+ * @param legacy_component
+ * @return
+ */
+bool Symbol::build_pins(const LegacyComponent* legacy_component) {
+    const Component::Pins& pins = legacy_component->pins;
+    std::pmr::vector<double> pos_x_mm = to_millimeters(pins.pos_x);
+    std::pmr::vector<double> pos_y_mm = to_millimeters(pins.pos_y);
+    std::pmr::vector<double> length_mm = to_millimeters(pins.length);
+    std::pmr::vector<double> name_size_mm =
+            to_millimeters(pins.text_name_size);
+    std::pmr::vector<double> num_size_mm = to_millimeters(pins.text_num_size);
+
+    for (std::size_t i = 0; i < pins.size(); i++) {
+        PinShape pin_shape = get_pin_shape(
+                legacy_component->get_string(pins.shape[i]));
+
+        sexpr.write("      (pin ", get_pin_type(pins.electric_type[i]), ' ',
+                    pin_shape.shape, " (at ", Fixed<3>{pos_x_mm[i]}, ' ',
+                    Fixed<3>{pos_y_mm[i]}, ' ',
+                    get_pin_orientation(pins.orientation[i]), ") (length ",
+                    Fixed<3>{length_mm[i]}, ")\n"
+                    "        (name \"",
+                    legacy_component->get_string(pins.name[i]),
+                    "\" (effects ");
+        build_font(name_size_mm[i]);
+        sexpr.write("))\n"
+                    "        (number \"",
+                    legacy_component->get_string(pins.number[i]),
+                    "\" (effects ");
+        build_font(num_size_mm[i]);
+        sexpr.line("))\n"
+                   "      )");
     }
 
-
     return true;
 }
 
-std::string Symbol::get_pin_type(const char identifier) {
-    std::string pin_type;
-
-    switch (identifier) {
-        case Component::PinElectricalType::INPUT:
-            pin_type = "input";
-            break;
-        case Component::PinElectricalType::OUTPUT:
-            pin_type = "output";
-            break;
-        case Component::PinElectricalType::BIDIRECTIONAL:
-            pin_type = "bidirectional";
-            break;
-        case Component::PinElectricalType::TRI_STATE:
-            pin_type = "tri_state";
-            break;
-        case Component::PinElectricalType::PASSIVE:
-            pin_type = "passive";
-            break;
-        case Component::PinElectricalType::POWER_INPUT:
-            pin_type = "power_in";
-            break;
-        case Component::PinElectricalType::POWER_OUTPUT:
-            pin_type = "power_out";
-            break;
-        case Component::PinElectricalType::OPEN_COLLECTOR:
-            pin_type = "open_collector";
-            break;
-        case Component::PinElectricalType::OPEN_EMITTER:
-            pin_type = "open_emitter";
-            break;
-        case Component::PinElectricalType::NOT_CONNECTED:
-            pin_type = "free";
-            break;
-        case Component::PinElectricalType::UNSPECIFIED:
-        default:
-            pin_type = "unspecified";
-            break;
+constexpr const char* Symbol::get_pin_type(const char identifier) {
+    for (const auto& pin_type: PIN_TYPES) {
+        if (pin_type.identifier == identifier) {
+            return pin_type.name;
+        }
     }
 
-    return pin_type;
+    return "unspecified";
 }
 
-Symbol::PinShape Symbol::get_pin_shape(const char* shape_buf) {
-    PinShape pin_shape;
+constexpr Symbol::PinShape Symbol::get_pin_shape(const char* shape_buf) {
+    PinShape pin_shape = {true, "line", '\0'}; // Default is line
 
     // Pin shape not found
-    if (strlen(shape_buf) == 0) {
-        pin_shape.shape = "line"; // Default is line
+    if (shape_buf[0] == '\0') {
         return pin_shape;
     }
 
@@ -556,81 +598,52 @@ Symbol::PinShape Symbol::get_pin_shape(const char* shape_buf) {
     if (shape_buf[0] == 'N') {
         offset = 1;
         pin_shape.visible = false;
-        pin_shape.identifier = shape_buf[offset++];
-    } else {
-        pin_shape.visible = true;
-        pin_shape.identifier = shape_buf[offset++];
     }
+    pin_shape.identifier = shape_buf[offset++];
 
-    switch (pin_shape.identifier) {
-        case 'I': // Inverted
-            pin_shape.shape = "inverted";
-            break;
-        case 'C': // Clock
-            if (shape_buf[offset] == 'I') { // CI
-                pin_shape.shape = "inverted_clock";
-            } else if (shape_buf[offset] == 'L') { // CL
-                pin_shape.shape = "clock_low";
-            } else { // C
-                pin_shape.shape = "clock";
-            }
-            break;
-        case 'L':
-            pin_shape.shape = "input_low";
-            break;
-        case 'V':
-            pin_shape.shape = "output_low";
-            break;
-        case 'F':
-            pin_shape.shape = "edge_clock_high";
-            break;
-        case 'X':
-            pin_shape.shape = "non_logic";
-            break;
-        default:
-            pin_shape.shape = "line";
+    // e.g. the I of CI (inverted clock)
+    char modifier = pin_shape.identifier != '\0' ? shape_buf[offset] : '\0';
+
+    for (const auto& shape: PIN_SHAPES) {
+        if (shape.identifier == pin_shape.identifier &&
+            (shape.modifier == '\0' || shape.modifier == modifier)) {
+            pin_shape.shape = shape.name;
             break;
+        }
     }
 
     return pin_shape;
 }
 
-int Symbol::get_pin_orientation(const char identifier) {
-    int angle;
-
-    switch (identifier) {
-        case 'D':
-            angle = 270;
-            break;
-        case 'R':
-            angle = 0;
-            break;
-        case 'L':
-            angle = 180;
-            break;
-        case 'U':
-        default:
-            angle = 90;
+constexpr int Symbol::get_pin_orientation(const char identifier) {
+    for (const auto& orientation: PIN_ORIENTATIONS) {
+        if (orientation.identifier == identifier) {
+            return orientation.angle;
+        }
     }
 
-    return angle;
+    return 90; // Up
 }
 
-bool Symbol::build_circles(const std::vector<Component::Circle>& circles) {
+bool Symbol::build_circles(const Component::Circles& circles) {
     double pos_x, pos_y;
     double radius;
     double stroke_width;
-    std::string fill;
+    const char* fill;
 
-    for (const auto& circle: circles) {
-        memset(buffer, 0, sizeof(buffer));
+    std::pmr::vector<double> pos_x_mm = to_millimeters(circles.pos_x);
+    std::pmr::vector<double> pos_y_mm = to_millimeters(circles.pos_y);
+    std::pmr::vector<double> radius_mm = to_millimeters(circles.radius);
+    std::pmr::vector<double> thickness_mm =
+            to_millimeters(circles.thickness);
 
-        pos_x = Utils::mils_to_millimeters(circle.pos_x);
-        pos_y = Utils::mils_to_millimeters(circle.pos_y);
-        radius = Utils::mils_to_millimeters(circle.radius);
-        stroke_width = Utils::mils_to_millimeters(circle.thickness);
+    for (std::size_t i = 0; i < circles.size(); i++) {
+        pos_x = pos_x_mm[i];
+        pos_y = pos_y_mm[i];
+        radius = radius_mm[i];
+        stroke_width = thickness_mm[i];
 
-        switch (circle.background) {
+        switch (circles.background[i]) {
             case 'F':
             case 'f':
                 fill = "background"; // Filled
@@ -641,43 +654,45 @@ bool Symbol::build_circles(const std::vector<Component::Circle>& circles) {
                 break;
         }
 
-        snprintf(buffer,
-                 sizeof(buffer),
-                 "      (circle (center %.3f %.3f) (radius %.3f)\n"
-                 "        (stroke (width %.3f) (type default))"
-                 " (fill (type %s))\n"
-                 "      )", pos_x, pos_y, radius, stroke_width, fill.c_str());
-
-        if (!write_to_file(buffer)) {
-            return false;
-        }
+        sexpr.line("      (circle (center ", Fixed<3>{pos_x}, ' ',
+                   Fixed<3>{pos_y}, ") (radius ", Fixed<3>{radius}, ")\n"
+                   "        (stroke (width ", Fixed<3>{stroke_width},
+                   ") (type default)) (fill (type ", fill, "))\n"
+                   "      )");
     }
 
     return true;
 }
 
-bool Symbol::build_arcs(const std::vector<Component::Arc>& arcs) {
+bool Symbol::build_arcs(const Component::Arcs& arcs) {
     double start_x, start_y;
     double mid_x, mid_y;
     double radius;
     double end_x, end_y;
     double stroke_width;
-    std::string fill;
-
-    for (const auto& arc: arcs) {
-        memset(buffer, 0, sizeof(buffer));
-
-        start_x = Utils::mils_to_millimeters(arc.start_point_x);
-        start_y = Utils::mils_to_millimeters(arc.start_point_y);
-        mid_x = Utils::mils_to_millimeters(arc.pos_x);
-        mid_y = Utils::mils_to_millimeters(arc.pos_y);
-        end_x = Utils::mils_to_millimeters(arc.end_point_x);
-        end_y = Utils::mils_to_millimeters(arc.end_point_y);
-        radius = Utils::mils_to_millimeters(arc.radius);
-
-        stroke_width = Utils::mils_to_millimeters(arc.thickness);
-
-        switch (arc.background) {
+    const char* fill;
+
+    std::pmr::vector<double> start_x_mm = to_millimeters(arcs.start_point_x);
+    std::pmr::vector<double> start_y_mm = to_millimeters(arcs.start_point_y);
+    std::pmr::vector<double> mid_x_mm = to_millimeters(arcs.pos_x);
+    std::pmr::vector<double> mid_y_mm = to_millimeters(arcs.pos_y);
+    std::pmr::vector<double> end_x_mm = to_millimeters(arcs.end_point_x);
+    std::pmr::vector<double> end_y_mm = to_millimeters(arcs.end_point_y);
+    std::pmr::vector<double> radius_mm = to_millimeters(arcs.radius);
+    std::pmr::vector<double> thickness_mm = to_millimeters(arcs.thickness);
+
+    for (std::size_t i = 0; i < arcs.size(); i++) {
+        start_x = start_x_mm[i];
+        start_y = start_y_mm[i];
+        mid_x = mid_x_mm[i];
+        mid_y = mid_y_mm[i];
+        end_x = end_x_mm[i];
+        end_y = end_y_mm[i];
+        radius = radius_mm[i];
+
+        stroke_width = thickness_mm[i];
+
+        switch (arcs.background[i]) {
             case 'F':
             case 'f':
                 fill = "background"; // Filled
@@ -688,41 +703,41 @@ bool Symbol::build_arcs(const std::vector<Component::Arc>& arcs) {
                 break;
         }
 
-        snprintf(buffer,
-                 sizeof(buffer),
-                 "      (arc (start %.3f %.3f) (mid %.3f %.3f) (end %.3f %.3f)\n"
-                 "        (stroke (width %.3f) (type default))\n"
-                 "        (fill (type %s))\n"
-                 "      )",
-                 start_x, start_y, (mid_x + radius), mid_y, end_x, end_y,
-                 stroke_width, fill.c_str());
-
-        if (!write_to_file(buffer)) {
-            return false;
-        }
+        sexpr.line("      (arc (start ", Fixed<3>{start_x}, ' ',
+                   Fixed<3>{start_y}, ") (mid ", Fixed<3>{mid_x + radius}, ' ',
+                   Fixed<3>{mid_y}, ") (end ", Fixed<3>{end_x}, ' ',
+                   Fixed<3>{end_y}, ")\n"
+                   "        (stroke (width ", Fixed<3>{stroke_width},
+                   ") (type default))\n"
+                   "        (fill (type ", fill, "))\n"
+                   "      )");
     }
 
     return true;
 }
 
-bool Symbol::build_rectangles(
-        const std::vector<Component::Rectangle>& rectangles) {
+bool Symbol::build_rectangles(const Component::Rectangles& rectangles) {
     double start_x, start_y;
     double end_x, end_y;
     double stroke_width;
-    std::string fill;
+    const char* fill;
 
-    for (const auto& rectangle: rectangles) {
-        memset(buffer, 0, sizeof(buffer));
+    std::pmr::vector<double> start_x_mm = to_millimeters(rectangles.start_x);
+    std::pmr::vector<double> start_y_mm = to_millimeters(rectangles.start_y);
+    std::pmr::vector<double> end_x_mm = to_millimeters(rectangles.end_x);
+    std::pmr::vector<double> end_y_mm = to_millimeters(rectangles.end_y);
+    std::pmr::vector<double> thickness_mm =
+            to_millimeters(rectangles.thickness);
 
-        start_x = Utils::mils_to_millimeters(rectangle.start_x);
-        start_y = Utils::mils_to_millimeters(rectangle.start_y);
-        end_x = Utils::mils_to_millimeters(rectangle.end_x);
-        end_y = Utils::mils_to_millimeters(rectangle.end_y);
+    for (std::size_t i = 0; i < rectangles.size(); i++) {
+        start_x = start_x_mm[i];
+        start_y = start_y_mm[i];
+        end_x = end_x_mm[i];
+        end_y = end_y_mm[i];
 
-        stroke_width = Utils::mils_to_millimeters(rectangle.thickness);
+        stroke_width = thickness_mm[i];
 
-        switch (rectangle.background) {
+        switch (rectangles.background[i]) {
             case 'F':
             case 'f':
                 fill = "background"; // Filled
@@ -733,50 +748,47 @@ bool Symbol::build_rectangles(
                 break;
         }
 
-        snprintf(buffer,
-                 sizeof(buffer),
-                 "      (rectangle (start %.3f %.3f) (end %.3f %.3f)\n"
-                 "        (stroke (width %.3f) (type default))"
-                 " (fill (type %s))\n"
-                 "      )",
-                 start_x, start_y, end_x, end_y, stroke_width, fill.c_str());
-
-        if (!write_to_file(buffer)) {
-            return false;
-        }
+        sexpr.line("      (rectangle (start ", Fixed<3>{start_x}, ' ',
+                   Fixed<3>{start_y}, ") (end ", Fixed<3>{end_x}, ' ',
+                   Fixed<3>{end_y}, ")\n"
+                   "        (stroke (width ", Fixed<3>{stroke_width},
+                   ") (type default)) (fill (type ", fill, "))\n"
+                   "      )");
     }
 
     return true;
 }
 
-bool Symbol::build_text_fields(
-        const std::vector<Component::Text>& text_fields) {
+bool Symbol::build_text_fields(const LegacyComponent* legacy_component) {
     double pos_x, pos_y;
     double rotation;
-    char text_effects[128];
-    std::string fill;
-
-    for (const auto& text_field: text_fields) {
-        memset(buffer, 0, sizeof(buffer));
-        memset(text_effects, 0, sizeof(text_effects));
-
-        pos_x = Utils::mils_to_millimeters(text_field.pos_x);
-        pos_y = Utils::mils_to_millimeters(text_field.pos_y);
-        rotation = Utils::mils_to_millimeters(text_field.orientation);
-
-        memcpy(text_effects, build_font(text_field.dimension),
-               sizeof(text_effects));
-
-        snprintf(buffer,
-                 sizeof(buffer),
-                 "      (text \"%s\" (at %.3f %.3f %.3f)\n"
-                 "        (effects %s)\n"
-                 "      )",
-                 text_field.text, pos_x, pos_y, rotation, text_effects);
-
-        if (!write_to_file(buffer)) {
-            return false;
-        }
+    double font_size;
+
+    std::pmr::vector<int> values(&arena);
+    values.reserve(legacy_component->texts.size() * 4);
+    for (const auto& text_field: legacy_component->texts) {
+        values.push_back(text_field.pos_x);
+        values.push_back(text_field.pos_y);
+        values.push_back(text_field.orientation);
+        values.push_back(text_field.dimension);
+    }
+    std::pmr::vector<double> values_mm = to_millimeters(values);
+
+    std::size_t i = 0;
+    for (const auto& text_field: legacy_component->texts) {
+        pos_x = values_mm[i++];
+        pos_y = values_mm[i++];
+        rotation = values_mm[i++];
+        font_size = values_mm[i++];
+
+        sexpr.write("      (text \"",
+                    legacy_component->get_string(text_field.text), "\" (at ",
+                    Fixed<3>{pos_x}, ' ', Fixed<3>{pos_y}, ' ',
+                    Fixed<3>{rotation}, ")\n"
+                    "        (effects ");
+        build_font(font_size);
+        sexpr.line(")\n"
+                   "      )");
     }
 
     return true;
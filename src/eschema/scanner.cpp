@@ -0,0 +1,177 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Harvey Bates
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "eschema/scanner.hpp"
+
+Scanner::Scanner(std::string_view line) : line(line) {}
+
+void Scanner::skip_space() {
+    while (pos < line.size() &&
+           (line[pos] == ' ' || line[pos] == '\t' || line[pos] == '\r')) {
+        pos++;
+    }
+}
+
+// Next field up to whitespace (empty at the end of the line)
+std::string_view Scanner::next_field() {
+    skip_space();
+
+    std::size_t start = pos;
+    while (pos < line.size() && line[pos] != ' ' && line[pos] != '\t' &&
+           line[pos] != '\r') {
+        pos++;
+    }
+
+    return line.substr(start, pos - start);
+}
+
+// Records where the first failure happened
+bool Scanner::fail(std::size_t field_pos) {
+    if (error_pos == std::string_view::npos) {
+        error_pos = field_pos;
+    }
+
+    return false;
+}
+
+// Matches a field exactly (e.g. "DEF")
+bool Scanner::keyword(std::string_view expected) {
+    skip_space();
+    std::size_t start = pos;
+
+    return next_field() == expected || fail(start);
+}
+
+// Skips a field (e.g. the record identifier)
+bool Scanner::skip() {
+    skip_space();
+    std::size_t start = pos;
+
+    return !next_field().empty() || fail(start);
+}
+
+/**
+ * @brief Reads a (decimal) integer, which may be followed directly by
+ * another field as with sscanf's %d.
+ */
+bool Scanner::integer(int& value) {
+    skip_space();
+    std::size_t start = pos;
+
+    const char* first = line.data() + pos;
+    const char* last = line.data() + line.size();
+
+    // from_chars doesn't accept a leading '+' (sscanf does)
+    if (last - first > 1 && first[0] == '+' && first[1] != '-') {
+        first++;
+    }
+
+    auto [end, error] = std::from_chars(first, last, value);
+
+    if (error != std::errc()) {
+        return fail(start);
+    }
+
+    pos = (std::size_t) (end - line.data());
+
+    return true;
+}
+
+// Reads the next character that isn't whitespace
+bool Scanner::character(char& value) {
+    skip_space();
+
+    return next_character(value);
+}
+
+// Reads the very next character (e.g. each letter of "CNN")
+bool Scanner::next_character(char& value) {
+    if (pos >= line.size()) {
+        return fail(pos);
+    }
+
+    value = line[pos++];
+
+    return true;
+}
+
+/**
+ * @brief Reads a field.
+ *
+ * @param value Field (refers to the line, nothing is copied).
+ */
+bool Scanner::word(std::string_view& value) {
+    skip_space();
+    std::size_t start = pos;
+    std::string_view field = next_field();
+
+    if (field.empty()) {
+        return fail(start);
+    }
+
+    value = field;
+
+    return true;
+}
+
+/**
+ * @brief Reads a quoted field, e.g. "Value" or "" (empty). The quotes aren't
+ * copied, escaped quotes (\") are kept as they are.
+ *
+ * @param value Field without the quotes (refers to the line).
+ */
+bool Scanner::quoted(std::string_view& value) {
+    skip_space();
+    std::size_t start = pos;
+
+    if (pos >= line.size() || line[pos] != '"') {
+        return fail(start);
+    }
+
+    std::size_t end = pos + 1;
+    while (end < line.size() && line[end] != '"') {
+        end += line[end] == '\\' ? 2 : 1;
+    }
+
+    if (end >= line.size()) {
+        return fail(start);
+    }
+
+    value = line.substr(pos + 1, end - pos - 1);
+    pos = end + 1;
+
+    return true;
+}
+
+// True if only whitespace is left
+bool Scanner::at_end() {
+    skip_space();
+
+    return pos >= line.size();
+}
+
+// Column (from 1) of the first field that failed to be read
+std::size_t Scanner::column() const {
+    return error_pos == std::string_view::npos ? 0 : error_pos + 1;
+}
@@ -0,0 +1,81 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Harvey Bates
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "eschema/sexpr.hpp"
+
+void SExpr::put(int value) {
+    char digits[16];
+    char* end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    out.append(digits, end);
+}
+
+/**
+ * @brief Appends a number with a fixed number of decimals without going
+ * through snprintf.
+ *
+ * @note The value is scaled and rounded to an integer, then written with
+ * std::to_chars. Values within a hair of a tie (half way between two
+ * results), and very large values, are left to snprintf, which rounds the
+ * exact binary value. Millimetres converted from integer mils never land
+ * on a tie at 3 decimals.
+ *
+ * @param value Number to format.
+ * @param precision Number of decimals.
+ * @param divisor 10 ^ precision.
+ */
+void SExpr::put_fixed(double value, int precision, uint64_t divisor) {
+    double scaled = std::fabs(value) * (double) divisor;
+    double fraction = scaled - std::floor(scaled);
+
+    // Also catches NaN and infinity (comparisons are false)
+    if (!(scaled < 1e9) || std::fabs(fraction - 0.5) < 1e-6) {
+        std::size_t start = out.size();
+        int length = snprintf(nullptr, 0, "%.*f", precision, value);
+        out.resize(start + length);
+        snprintf(&out[start], length + 1, "%.*f", precision, value);
+        out.resize(start + length);
+        return;
+    }
+
+    auto rounded = (uint64_t) std::llround(scaled);
+    char digits[32];
+    char* end = digits;
+
+    if (std::signbit(value)) {
+        *end++ = '-';
+    }
+    end = std::to_chars(end, digits + sizeof(digits), rounded / divisor).ptr;
+
+    if (precision > 0) {
+        uint64_t decimals = rounded % divisor;
+        *end = '.';
+        for (int i = precision; i > 0; i--) {
+            end[i] = (char) ('0' + decimals % 10);
+            decimals /= 10;
+        }
+        end += precision + 1;
+    }
+
+    out.append(digits, end);
+}
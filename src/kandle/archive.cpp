@@ -0,0 +1,587 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Harvey Bates
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "kandle/archive.h"
+
+namespace fs = std::filesystem;
+
+// Record signatures and fixed sizes from the PKWARE APPNOTE
+static const uint32_t LOCAL_HEADER_SIGNATURE = 0x04034b50;
+static const uint32_t CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+static const uint32_t END_OF_CENTRAL_DIR_SIGNATURE = 0x06054b50;
+static const std::size_t LOCAL_HEADER_SIZE = 30;
+static const std::size_t CENTRAL_HEADER_SIZE = 46;
+static const std::size_t END_OF_CENTRAL_DIR_SIZE = 22;
+static const std::size_t MAX_COMMENT_SIZE = 0xFFFF;
+
+static const uint16_t METHOD_STORED = 0;
+static const uint16_t METHOD_DEFLATED = 8;
+static const uint16_t FLAG_ENCRYPTED = 0x0001;
+
+// Deflate can't expand data by more than this (258 bytes from 2 bits)
+static const uint64_t MAX_DEFLATE_RATIO = 1032;
+
+static uint16_t read16(const char* p) {
+    auto u = reinterpret_cast<const unsigned char*>(p);
+    return (uint16_t) (u[0] | (u[1] << 8));
+}
+
+static uint32_t read32(const char* p) {
+    auto u = reinterpret_cast<const unsigned char*>(p);
+    return (uint32_t) u[0] | ((uint32_t) u[1] << 8) |
+           ((uint32_t) u[2] << 16) | ((uint32_t) u[3] << 24);
+}
+
+Kandle::Archive::~Archive() {
+    if (mapping) {
+        munmap(mapping, size);
+    }
+}
+
+/**
+ * @brief Memory maps a file (read only).
+ *
+ * @param path Path to the file.
+ * @param region Start of the mapped region.
+ * @param length Length of the file (and mapped region).
+ * @return True if the file was mapped.
+ */
+bool Kandle::Archive::map(const std::string& path, void** region,
+                          std::size_t* length) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* start = mmap(nullptr, (std::size_t) st.st_size, PROT_READ,
+                       MAP_PRIVATE, fd, 0);
+    ::close(fd); // Mapping remains valid once the file is closed
+
+    if (start == MAP_FAILED) {
+        return false;
+    }
+
+    *region = start;
+    *length = (std::size_t) st.st_size;
+
+    return true;
+}
+
+bool Kandle::Archive::open(const std::string& path) {
+    if (mapping) {
+        munmap(mapping, size);
+        mapping = nullptr;
+    }
+
+    if (!map(path, &mapping, &size)) {
+        std::cerr << "Unable to open archive: " << path << std::endl;
+        size = 0;
+        return false;
+    }
+
+    data = static_cast<const char*>(mapping);
+
+    return read_central_directory();
+}
+
+/**
+ * @brief Opens an archive that is already in memory (e.g. a nested archive).
+ *
+ * @param contents Contents of the .zip file (owned by the archive).
+ * @return True if the central directory was read successfully.
+ */
+bool Kandle::Archive::open_memory(std::string contents) {
+    if (mapping) {
+        munmap(mapping, size);
+        mapping = nullptr;
+    }
+
+    buffer = std::move(contents);
+    data = buffer.data();
+    size = buffer.size();
+
+    return read_central_directory();
+}
+
+/**
+ * @brief Opens a member of this archive that is itself a .zip file, without
+ * writing it to disk.
+ *
+ * @param entry Member of this archive.
+ * @param nested Archive to open the member in.
+ * @return True if the nested archive was opened.
+ */
+bool Kandle::Archive::open_nested(const Entry& entry, Archive& nested) const {
+    if (depth >= MAX_NESTING_DEPTH) {
+        return false;
+    }
+
+    std::string contents;
+    if (!read(entry, contents)) {
+        return false;
+    }
+
+    nested.depth = depth + 1;
+
+    return nested.open_memory(std::move(contents));
+}
+
+/**
+ * @brief Checks that a file ends with an end of central directory record.
+ * Only the tail of the file is touched (not the whole archive).
+ *
+ * @param path Path to the file.
+ * @return True if the file looks like a .zip file.
+ */
+bool Kandle::Archive::is_zip(const std::string& path) {
+    void* region;
+    std::size_t length;
+
+    if (!map(path, &region, &length)) {
+        return false;
+    }
+
+    bool found = find_end_of_central_directory(
+            static_cast<const char*>(region), length) != std::string::npos;
+
+    munmap(region, length);
+
+    return found;
+}
+
+const std::vector<Kandle::Archive::Entry>& Kandle::Archive::entries() const {
+    return members;
+}
+
+// Hash of the raw archive bytes (used to tell if an archive has changed)
+uint64_t Kandle::Archive::checksum() const {
+    return Utils::xxhash64(data, size);
+}
+
+/**
+ * @brief Searches backwards (over a possible trailing comment) for the end
+ * of central directory record.
+ *
+ * @return Offset of the record, or std::string::npos if not found.
+ */
+std::size_t Kandle::Archive::find_end_of_central_directory(
+        const char* start, std::size_t length) {
+
+    if (length < END_OF_CENTRAL_DIR_SIZE) {
+        return std::string::npos;
+    }
+
+    std::size_t lowest = 0;
+    if (length > END_OF_CENTRAL_DIR_SIZE + MAX_COMMENT_SIZE) {
+        lowest = length - END_OF_CENTRAL_DIR_SIZE - MAX_COMMENT_SIZE;
+    }
+
+    for (std::size_t pos = length - END_OF_CENTRAL_DIR_SIZE;; pos--) {
+        if (read32(start + pos) == END_OF_CENTRAL_DIR_SIGNATURE) {
+            return pos;
+        }
+        if (pos == lowest) {
+            break;
+        }
+    }
+
+    return std::string::npos;
+}
+
+/**
+ * @brief Reads every entry of the central directory.
+ *
+ * @return True if the central directory was read successfully.
+ */
+bool Kandle::Archive::read_central_directory() {
+    members.clear();
+
+    std::size_t eocd = find_end_of_central_directory(data, size);
+
+    if (eocd == std::string::npos) {
+        return false;
+    }
+
+    uint16_t n_entries = read16(&data[eocd + 10]);
+    uint32_t cd_size = read32(&data[eocd + 12]);
+    uint32_t cd_offset = read32(&data[eocd + 16]);
+
+    if ((std::size_t) cd_offset + cd_size > eocd) {
+        return false;
+    }
+
+    std::size_t pos = cd_offset;
+    for (uint16_t i = 0; i < n_entries; i++) {
+        if (pos + CENTRAL_HEADER_SIZE > eocd ||
+            read32(&data[pos]) != CENTRAL_HEADER_SIGNATURE) {
+            return false;
+        }
+
+        const char* header = &data[pos];
+        uint16_t flags = read16(header + 8);
+        uint16_t name_length = read16(header + 28);
+        uint16_t extra_length = read16(header + 30);
+        uint16_t comment_length = read16(header + 32);
+
+        Entry entry;
+        entry.method = read16(header + 10);
+        entry.crc32 = read32(header + 16);
+        entry.compressed_size = read32(header + 20);
+        entry.uncompressed_size = read32(header + 24);
+        entry.local_header_offset = read32(header + 42);
+
+        if (pos + CENTRAL_HEADER_SIZE + name_length > eocd) {
+            return false;
+        }
+        entry.name.assign(header + CENTRAL_HEADER_SIZE, name_length);
+
+        // Encrypted and ZIP64 members are not supported
+        if (flags & FLAG_ENCRYPTED ||
+            entry.compressed_size == 0xFFFFFFFF ||
+            entry.uncompressed_size == 0xFFFFFFFF ||
+            entry.local_header_offset == 0xFFFFFFFF) {
+            std::cerr << "Unsupported archive member: " << entry.name
+                      << std::endl;
+            return false;
+        }
+
+        members.push_back(entry);
+
+        pos += CENTRAL_HEADER_SIZE + name_length + extra_length +
+               comment_length;
+    }
+
+    return true;
+}
+
+bool Kandle::Archive::is_directory(const Entry& entry) {
+    return !entry.name.empty() && entry.name.back() == '/';
+}
+
+bool Kandle::Archive::is_archive(const Entry& entry) {
+    std::string extension = fs::path(entry.name).extension();
+    return extension == ".zip" || extension == ".ZIP";
+}
+
+// Members must stay inside the output directory (no absolute paths or "..")
+bool Kandle::Archive::safe_name(const std::string& name) {
+    fs::path member_path(name);
+
+    if (name.empty() || member_path.is_absolute() || name[0] == '/') {
+        return false;
+    }
+
+    for (const auto& part: member_path) {
+        if (part == "..") {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Finds the start of a members (compressed) data by skipping over its
+ * local file header.
+ */
+bool Kandle::Archive::member_data(const Entry& entry,
+                                  const char** start) const {
+    std::size_t pos = entry.local_header_offset;
+
+    if (pos + LOCAL_HEADER_SIZE > size ||
+        read32(&data[pos]) != LOCAL_HEADER_SIGNATURE) {
+        return false;
+    }
+
+    uint16_t name_length = read16(&data[pos + 26]);
+    uint16_t extra_length = read16(&data[pos + 28]);
+
+    pos += LOCAL_HEADER_SIZE + name_length + extra_length;
+
+    if (pos + entry.compressed_size > size) {
+        return false;
+    }
+
+    *start = &data[pos];
+
+    return true;
+}
+
+/**
+ * @brief Decompresses a single member into memory.
+ *
+ * @param entry Member of this archive (from entries()).
+ * @param contents Uncompressed contents of the member.
+ * @return True if the member was read and its checksum matched.
+ */
+bool Kandle::Archive::read(const Entry& entry, std::string& contents) const {
+    const char* start;
+
+    if (!member_data(entry, &start)) {
+        return false;
+    }
+
+    contents.clear();
+
+    if (entry.method == METHOD_STORED) {
+        contents.assign(start, entry.compressed_size);
+    } else if (entry.method == METHOD_DEFLATED) {
+        // The size comes from the (untrusted) header, so it is checked
+        // against the compressed data (which is inside the archive) before
+        // anything is allocated
+        if (entry.uncompressed_size >
+            (uint64_t) entry.compressed_size * MAX_DEFLATE_RATIO) {
+            std::cerr << "Invalid size for archive member: " << entry.name
+                      << std::endl;
+            return false;
+        }
+
+        contents.resize(entry.uncompressed_size);
+
+        z_stream stream{};
+        // Negative window bits for a raw deflate stream (no zlib header)
+        if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+            return false;
+        }
+
+        stream.next_in = (Bytef*) start;
+        stream.avail_in = entry.compressed_size;
+        stream.next_out = (Bytef*) contents.data();
+        stream.avail_out = entry.uncompressed_size;
+
+        int res = inflate(&stream, Z_FINISH);
+        inflateEnd(&stream);
+
+        if (res != Z_STREAM_END ||
+            stream.total_out != entry.uncompressed_size) {
+            return false;
+        }
+    } else {
+        std::cerr << "Unsupported compression method for: " << entry.name
+                  << std::endl;
+        return false;
+    }
+
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, (const Bytef*) contents.data(), (uInt) contents.size());
+
+    return crc == entry.crc32;
+}
+
+/**
+ * @brief Inflates a deflated member in chunks, directly into an output
+ * stream (the whole member is never held in memory).
+ *
+ * @return True if the member was inflated and its checksum matched.
+ */
+bool Kandle::Archive::inflate_to(const Entry& entry, const char* start,
+                                 std::ostream& output) const {
+    char chunk[65536];
+    uLong crc = crc32(0L, Z_NULL, 0);
+
+    z_stream stream{};
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+        return false;
+    }
+
+    stream.next_in = (Bytef*) start;
+    stream.avail_in = entry.compressed_size;
+
+    int res;
+    do {
+        stream.next_out = (Bytef*) chunk;
+        stream.avail_out = sizeof(chunk);
+
+        res = inflate(&stream, Z_NO_FLUSH);
+        if (res != Z_OK && res != Z_STREAM_END) {
+            break;
+        }
+
+        std::size_t produced = sizeof(chunk) - stream.avail_out;
+        crc = crc32(crc, (const Bytef*) chunk, (uInt) produced);
+        output.write(chunk, (std::streamsize) produced);
+    } while (res != Z_STREAM_END && (stream.avail_in || !stream.avail_out));
+
+    inflateEnd(&stream);
+
+    return res == Z_STREAM_END &&
+           stream.total_out == entry.uncompressed_size &&
+           crc == entry.crc32 && output.good();
+}
+
+/**
+ * @brief Extracts a single member into a directory.
+ *
+ * @note Members that would be written outside the directory (absolute
+ * paths or "..") are skipped with a warning, they aren't an error.
+ *
+ * @return True if the member was extracted (or skipped).
+ */
+bool Kandle::Archive::extract(const Entry& entry,
+                              const std::string& output_directory) const {
+    if (!safe_name(entry.name)) {
+        std::cerr << "Skipping unsafe archive member: " << entry.name
+                  << std::endl;
+        return true;
+    }
+
+    fs::path output_path = fs::path(output_directory) / entry.name;
+
+    if (is_directory(entry)) {
+        fs::create_directories(output_path);
+        return true;
+    }
+
+    const char* start;
+    if (!member_data(entry, &start) ||
+        (entry.method != METHOD_STORED && entry.method != METHOD_DEFLATED)) {
+        std::cerr << "Unable to read archive member: " << entry.name
+                  << std::endl;
+        return false;
+    }
+
+    fs::create_directories(output_path.parent_path());
+
+    std::ofstream outfile(output_path, std::ios::out | std::ios::binary);
+    if (!outfile.is_open()) {
+        return false;
+    }
+
+    bool extracted;
+    if (entry.method == METHOD_STORED) {
+        // Written straight from the mapped archive
+        uLong crc = crc32(0L, Z_NULL, 0);
+        crc = crc32(crc, (const Bytef*) start, (uInt) entry.compressed_size);
+        outfile.write(start, (std::streamsize) entry.compressed_size);
+        extracted = crc == entry.crc32 && outfile.good();
+    } else {
+        extracted = inflate_to(entry, start, outfile);
+    }
+
+    outfile.close();
+
+    if (!extracted) {
+        std::cerr << "Unable to read archive member: " << entry.name
+                  << std::endl;
+    }
+
+    return extracted;
+}
+
+/**
+ * @brief Runs a task for each entry on a small pool of threads. The largest
+ * members (usually 3D models) are started first so they overlap with the
+ * smaller text files.
+ *
+ * @param entries Members of this archive.
+ * @param task Called with the index of each entry, returns false on error.
+ * @return True if every task succeeded.
+ */
+bool Kandle::Archive::for_each_parallel(
+        const std::vector<Entry>& entries,
+        const std::function<bool(std::size_t)>& task) {
+    std::vector<std::size_t> order(entries.size());
+    for (std::size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return entries[a].uncompressed_size > entries[b].uncompressed_size;
+    });
+
+    return Utils::parallel_for(order.size(), [&](std::size_t i) {
+        return task(order[i]);
+    }, MAX_THREADS);
+}
+
+/**
+ * @brief Decompresses several members into memory in parallel.
+ *
+ * @param entries Members of this archive (from entries()).
+ * @param contents Uncompressed contents of each member (same order).
+ * @return True if every member was read and its checksum matched.
+ */
+bool Kandle::Archive::read(const std::vector<Entry>& entries,
+                           std::vector<std::string>& contents) const {
+    contents.assign(entries.size(), std::string());
+
+    return for_each_parallel(entries, [&](std::size_t i) {
+        return read(entries[i], contents[i]);
+    });
+}
+
+bool Kandle::Archive::extract(const std::vector<Entry>& entries,
+                              const std::string& output_directory) const {
+    // Create directories up front so threads don't race to create them
+    for (const auto& entry: entries) {
+        if (safe_name(entry.name)) {
+            fs::path output_path = fs::path(output_directory) / entry.name;
+            fs::create_directories(is_directory(entry) ? output_path :
+                                   output_path.parent_path());
+        }
+    }
+
+    return for_each_parallel(entries, [&](std::size_t i) {
+        return extract(entries[i], output_directory);
+    });
+}
+
+/**
+ * @brief Extracts every member. Nested archives are also extracted (from
+ * memory) into a directory of the same name, without the extension.
+ */
+bool Kandle::Archive::extract_all(const std::string& output_directory) const {
+    if (!extract(members, output_directory)) {
+        return false;
+    }
+
+    for (const auto& entry: members) {
+        if (!is_archive(entry) || !safe_name(entry.name)) {
+            continue;
+        }
+
+        Archive nested;
+        if (!open_nested(entry, nested)) {
+            std::cerr << "Skipping nested archive: " << entry.name
+                      << std::endl;
+            continue;
+        }
+
+        fs::path nested_directory = fs::path(output_directory) / entry.name;
+        nested_directory.replace_extension();
+
+        if (!nested.extract_all(nested_directory)) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -27,17 +27,39 @@
 namespace fs = std::filesystem;
 
 std::string output_directory;
+static std::string component_name;
 static Kandle::FileHandler::FilePaths library_file_paths;
 
-std::string Kandle::FileHandler::unzip(const std::string& path) {
+// Records which archive (and mode) a tmp directory was extracted from
+static const char* EXTRACTION_STAMP = ".kandle_stamp";
 
-    validate_zip_file(path);
+// Prints a whole line at once (components may be loaded on several threads)
+template<typename... Args>
+static void report(const Args& ... args) {
+    static std::mutex mutex;
+    std::ostringstream line;
+    (line << ... << args);
 
-    std::cout << "Extracting from: " << path << std::endl;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::cout << line.str() << std::endl;
+}
 
-    std::string output_path = "components/extern/tmp/";
+/**
+ * @brief Name given to the imported component (footprint and 3D model
+ * filenames) derived from the vendor file name.
+ *
+ * @example "LIB_PESD 0402-140.zip" becomes "PESD_0402_140" (as does
+ * "LIB_PESD 0402-140.tar.gz").
+ */
+std::string Kandle::FileHandler::build_component_name(
+        const std::string& path) {
     std::string filename = fs::path(path).stem();
 
+    // Remove the rest of a .tar.gz extension
+    if (fs::path(filename).extension() == ".tar") {
+        filename = fs::path(filename).stem();
+    }
+
     // Remove ultra-librarian prefix
     if (filename.substr(0, 3) == "ul_") {
       filename = filename.substr(3);
@@ -52,24 +74,113 @@ std::string Kandle::FileHandler::unzip(const std::string& path) {
     std::replace(filename.begin(), filename.end(), ' ', '_');
     std::replace(filename.begin(), filename.end(), '-', '_');
 
-    output_path += filename; // Add new filename to path
+    return filename;
+}
+
+/**
+ * @brief Builds the stamp written into an extracted directory from the hash
+ * of the archive and the extraction mode.
+ */
+std::string Kandle::FileHandler::extraction_stamp(const Archive& archive,
+                                                  bool selective) {
+    char buf[32];
+
+    snprintf(buf, sizeof(buf), "%016llx %s",
+             (unsigned long long) archive.checksum(),
+             selective ? "selective" : "all");
+
+    return buf;
+}
+
+/**
+ * @brief Extracts a vendor .zip file into components/extern/tmp.
+ *
+ * @note If the output directory was already extracted from an identical
+ * archive (same hash and mode) extraction is skipped. Otherwise, the
+ * directory is stale and is extracted again.
+ *
+ * @param path Path to the .zip file.
+ * @param selective Only extract the symbol, footprint and 3D model that
+ * recursive_extract_paths() will use (other vendor formats are skipped).
+ * @return Path to the extracted directory.
+ */
+std::string Kandle::FileHandler::unzip(const std::string& path,
+                                       bool selective) {
+
+    if (!validate_zip_file(path)) {
+        exit(1);
+    }
+
+    std::cout << "Extracting from: " << path << std::endl;
+
+    std::string output_path = "components/extern/tmp/";
+    component_name = build_component_name(path);
+
+    output_path += component_name; // Add new filename to path
 
     std::cout << "Extracting to: " << output_path << std::endl;
 
-    if (fs::exists(output_path)) {
-        std::cout << "Output directory: " << output_path << " already exists."
-                  << std::endl;
-        output_directory = output_path;
-        return output_path;
+    Archive archive;
+    bool extracted = archive.open(path);
+
+    std::string stamp = extraction_stamp(archive, selective);
+    fs::path stamp_path = fs::path(output_path) / EXTRACTION_STAMP;
+
+    if (extracted && fs::exists(output_path)) {
+        std::string existing_stamp;
+        std::ifstream stamp_file(stamp_path);
+        std::getline(stamp_file, existing_stamp);
+
+        if (existing_stamp == stamp) {
+            std::cout << "Output directory: " << output_path
+                      << " already extracted from this file." << std::endl;
+            output_directory = output_path;
+            return output_path;
+        }
+
+        std::cout << "Output directory: " << output_path
+                  << " is out of date. Extracting again." << std::endl;
+        fs::remove_all(output_path);
+    }
+
+    // Created up front, an archive with nothing selected still extracts to
+    // an (empty) stamped directory
+    if (extracted) {
+        fs::create_directories(output_path);
     }
 
-    std::ostringstream oss;
-    oss << "unzip \"" << path << "\" -d \"" << output_path
-        << "\" > /dev/null 2>&1";
-    std::string cmd = oss.str();
+    if (extracted && selective) {
+        Selection selection = select_members(archive);
+
+        // Members of the same archive are inflated together (in parallel),
+        // into the directory of that archive
+        std::set<const Archive*> archives;
+        for (const auto& member: selection.members) {
+            archives.insert(member.archive);
+        }
+
+        for (const auto* member_archive: archives) {
+            std::vector<Archive::Entry> entries;
+            std::string directory;
+            for (const auto& member: selection.members) {
+                if (member.archive == member_archive) {
+                    entries.push_back(member.entry);
+                    directory = member.directory;
+                }
+            }
+
+            extracted = extracted && member_archive->extract(
+                    entries, (fs::path(output_path) / directory).string());
+        }
+    } else if (extracted) {
+        extracted = archive.extract_all(output_path);
+    }
+
+    if (extracted) {
+        std::ofstream stamp_file(stamp_path);
+        stamp_file << stamp << "\n";
+        stamp_file.close();
 
-    int err = std::system(cmd.c_str());
-    if (err == 0) {
         std::cout << "Successfully extracted to: " << output_path << std::endl;
         output_directory = output_path;
         return output_path;
@@ -80,24 +191,30 @@ std::string Kandle::FileHandler::unzip(const std::string& path) {
     exit(1);
 }
 
-// Check that the input file path actually contains a .zip file
+// Check that the input file path actually contains a .zip file (reported
+// if not)
 bool Kandle::FileHandler::validate_zip_file(const std::string& path) {
 
     if (!fs::is_regular_file(path)) {
-        std::cerr << "Error unknown file: \"" << path << "\". Exiting."
-                  << std::endl;
-        exit(1);
+        std::cerr << "Error unknown file: \"" << path << "\"." << std::endl;
+        return false;
     }
 
     auto zip_path = fs::path(path);
 
     if (zip_path.extension() == ".zip") {
-        return true;
+        if (Archive::is_zip(path)) {
+            return true;
+        }
+
+        std::cerr << "Error invalid .zip file: \"" << path << "\"."
+                  << std::endl;
+        return false;
     }
 
-    std::cerr << "Error unsupported filetype: \"" << path << "\". Exiting."
+    std::cerr << "Error unsupported filetype: \"" << path << "\"."
               << std::endl;
-    exit(1);
+    return false;
 }
 
 void Kandle::FileHandler::build_library_paths(
@@ -117,98 +234,566 @@ void Kandle::FileHandler::build_library_paths(
     library_file_paths.dmodel += library_name;
 }
 
+/**
+ * @brief Decides if an item (file or directory) is a component file that
+ * should be imported. Only the first of each type is selected, unless a
+ * "KiCad" directory is found (Component Search Engine), in which case
+ * selection starts again from that directory.
+ *
+ * @param item Path to a file or directory.
+ * @return The type of component file, or none if it should be ignored.
+ */
+Kandle::FileHandler::MemberType Kandle::FileHandler::Selector::select(
+        const fs::path& item) {
+
+    if (item.stem() == "KiCad") {
+        symbol_found = false;
+        footprint_found = false;
+        dmodel_found = false;
+        return MemberType::component_root;
+    }
+
+    if (!symbol_found && item.extension() == ".kicad_sym") {
+        symbol_found = true;
+        return MemberType::symbol;
+    }
+
+    if (!symbol_found && item.extension() == ".lib") {
+        symbol_found = true;
+        return MemberType::legacy_symbol;
+    }
+
+    if (!footprint_found && item.extension() == ".kicad_mod") {
+        footprint_found = true;
+        return MemberType::footprint;
+    }
+
+    if (!dmodel_found && (item.extension() == ".stp" ||
+                          item.extension() == ".step")) {
+        dmodel_found = true;
+        return MemberType::dmodel;
+    }
+
+    return MemberType::none;
+}
+
+/**
+ * @brief Selects the archive members that would be picked by
+ * recursive_extract_paths() had the whole archive been extracted.
+ *
+ * @note Members are visited in archive order. Parent directories are offered
+ * to the selector before their contents (as a directory walk would) as
+ * archives don't always contain entries for directories.
+ *
+ * @note Nested archives (e.g. a KiCad specific .zip inside an all formats
+ * .zip) are opened in memory and treated as a directory of the same name.
+ *
+ * @param archive Opened vendor archive.
+ * @return The symbol, footprint and 3D model members (if found).
+ */
+Kandle::FileHandler::Selection Kandle::FileHandler::select_members(
+        const Archive& archive) {
+    Selection selection;
+    Selector selector;
+    std::set<std::string> directories;
+    Member selected[3]{}; // Symbol, footprint and 3D model
+
+    select_members(archive, "", selector, directories, selected,
+                   selection.nested);
+
+    for (const auto& member: selected) {
+        if (member.type != MemberType::none) {
+            selection.members.push_back(member);
+        }
+    }
+
+    return selection;
+}
+
+void Kandle::FileHandler::select_members(
+        const Archive& archive, const fs::path& prefix, Selector& selector,
+        std::set<std::string>& directories, Member (& selected)[3],
+        std::vector<std::unique_ptr<Archive>>& nested) {
+
+    for (const auto& entry: archive.entries()) {
+        fs::path member = prefix / entry.name;
+
+        fs::path directory;
+        for (const auto& part: member.parent_path()) {
+            directory /= part;
+            if (directories.insert(directory.string()).second) {
+                selector.select(directory);
+            }
+        }
+
+        if (Archive::is_directory(entry)) {
+            continue;
+        }
+
+        if (Archive::is_archive(entry)) {
+            auto inner = std::make_unique<Archive>();
+            if (!archive.open_nested(entry, *inner)) {
+                std::cerr << "Skipping nested archive: " << member
+                          << std::endl;
+                continue;
+            }
+
+            fs::path inner_prefix = fs::path(member).replace_extension();
+            directories.insert(inner_prefix.string());
+            selector.select(inner_prefix);
+
+            select_members(*inner, inner_prefix, selector, directories,
+                           selected, nested);
+            nested.push_back(std::move(inner));
+            continue;
+        }
+
+        MemberType type = selector.select(member);
+        int slot = selection_slot(type);
+
+        if (slot >= 0) {
+            selected[slot] = {type, entry, &archive, prefix.string()};
+        }
+    }
+}
+
+// Position of a member type in a selection (symbol, footprint, 3D model)
+int Kandle::FileHandler::selection_slot(MemberType type) {
+    switch (type) {
+        case MemberType::symbol:
+        case MemberType::legacy_symbol:
+            return 0;
+        case MemberType::footprint:
+            return 1;
+        case MemberType::dmodel:
+            return 2;
+        default:
+            return -1;
+    }
+}
+
+/**
+ * @brief Reads selected members (possibly from several nested archives)
+ * into memory.
+ *
+ * @param members Selected members.
+ * @param contents Uncompressed contents of each member (same order).
+ * @return True if every member was read.
+ */
+bool Kandle::FileHandler::read_members(const std::vector<Member>& members,
+                                       std::vector<std::string>& contents) {
+    contents.assign(members.size(), std::string());
+
+    // Members of the same archive are inflated together (in parallel)
+    std::set<const Archive*> archives;
+    for (const auto& member: members) {
+        archives.insert(member.archive);
+    }
+
+    for (const auto* archive: archives) {
+        std::vector<std::size_t> indices;
+        std::vector<Archive::Entry> entries;
+        for (std::size_t i = 0; i < members.size(); i++) {
+            if (members[i].archive == archive) {
+                indices.push_back(i);
+                entries.push_back(members[i].entry);
+            }
+        }
+
+        std::vector<std::string> archive_contents;
+        if (!archive->read(entries, archive_contents)) {
+            return false;
+        }
+
+        for (std::size_t i = 0; i < indices.size(); i++) {
+            contents[indices[i]] = std::move(archive_contents[i]);
+        }
+    }
+
+    return true;
+}
+
 Kandle::FileHandler::FilePaths Kandle::FileHandler::recursive_extract_paths(
         const std::string& library_name) {
-    bool symbol_found = false;
-    bool footprint_found = false;
-    bool dmodel_found = false;
-
+    Selector selector;
     FilePaths component_file_paths;
     build_library_paths(library_name);
 
+    // Nothing was extracted
+    if (!fs::is_directory(output_directory)) {
+        return component_file_paths;
+    }
+
     for (const auto& dir_item: fs::recursive_directory_iterator{
             output_directory}) {
         auto item = fs::path(dir_item);
 
-        if (item.stem() == "KiCad") {
-            std::cout << "Component Search Engine component detected."
-                      << std::endl;
-            symbol_found = false;
-            footprint_found = false;
-            dmodel_found = false;
+        switch (selector.select(item)) {
+            case MemberType::component_root:
+                std::cout << "Component Search Engine component detected."
+                          << std::endl;
+                break;
+            case MemberType::symbol:
+                std::cout << "Found symbol: " << item << std::endl;
+                component_file_paths.symbol = item;
+                break;
+            case MemberType::legacy_symbol:
+                // Converted when imported
+                component_file_paths.symbol = item;
+                break;
+            case MemberType::footprint:
+                std::cout << "Found footprint: " << item << std::endl;
+                component_file_paths.footprint = item;
+                break;
+            case MemberType::dmodel:
+                std::cout << "Found 3D model: " << item << std::endl;
+                component_file_paths.dmodel = item;
+                break;
+            case MemberType::none:
+                break;
         }
+    }
+
+    return component_file_paths;
+}
+
+/**
+ * @brief Reads the selected component files into memory from either a
+ * vendor .zip file or a .tar.gz/.tgz file (nothing is written to
+ * components/extern/tmp).
+ *
+ * @note Errors are reported here and nothing is returned, the caller
+ * decides whether to carry on (this runs on worker threads).
+ *
+ * @param path Path to the file ("-" reads a tarball from stdin).
+ * @return Contents of the symbol, footprint and 3D model (empty if the file
+ * couldn't be read or converted).
+ */
+std::optional<Kandle::FileHandler::FileContents> Kandle::FileHandler::load(
+        const std::string& path) {
+
+    if (Tarball::is_tarball(path)) {
+        return load_tarball(path);
+    }
+
+    return load_archive(path);
+}
+
+/**
+ * @brief Reads the component files of several vendor files at once, each
+ * file is read (and converted) on its own thread.
+ *
+ * @param paths Paths to the files.
+ * @return Contents of each component (same order as paths), empty for the
+ * files that couldn't be loaded (already reported).
+ */
+std::vector<std::optional<Kandle::FileHandler::FileContents>>
+Kandle::FileHandler::load(const std::vector<std::string>& paths) {
+    std::vector<std::optional<FileContents>> components(paths.size());
 
-        if (!symbol_found && item.extension() == ".kicad_sym") {
-            std::cout << "Found symbol: " << item << std::endl;
-            component_file_paths.symbol = item;
-            symbol_found = true;
+    Utils::parallel_for(paths.size(), [&](std::size_t i) {
+        components[i] = load(paths[i]);
+        return true;
+    }, MAX_THREADS);
+
+    return components;
+}
+
+/**
+ * @brief Reads the selected component files straight out of a vendor .zip
+ * file into memory.
+ *
+ * @param path Path to the .zip file.
+ * @return Contents of the symbol, footprint and 3D model (empty on error).
+ */
+std::optional<Kandle::FileHandler::FileContents>
+Kandle::FileHandler::load_archive(const std::string& path) {
+
+    if (!validate_zip_file(path)) {
+        return std::nullopt;
+    }
+
+    report("Reading from: ", path);
+
+    Archive archive;
+    if (!archive.open(path)) {
+        std::cerr << "Files could not be read from: " << path << std::endl;
+        return std::nullopt;
+    }
+
+    Selection selection = select_members(archive);
+
+    // Members are inflated in parallel then converted in order
+    std::vector<std::string> member_data;
+    if (!read_members(selection.members, member_data)) {
+        std::cerr << "Files could not be read from: " << path << std::endl;
+        return std::nullopt;
+    }
+
+    return build_file_contents(selection.members, member_data,
+                               build_component_name(path));
+}
+
+/**
+ * @brief Reads the selected component files from a .tar.gz/.tgz file in a
+ * single forward pass. Only the selected members are kept in memory.
+ *
+ * @note When reading from stdin the component is named after the top level
+ * directory of the tarball.
+ *
+ * @param path Path to the tarball or "-" for stdin.
+ * @return Contents of the symbol, footprint and 3D model (empty on error).
+ */
+std::optional<Kandle::FileHandler::FileContents>
+Kandle::FileHandler::load_tarball(const std::string& path) {
+
+    if (path != "-" && !fs::is_regular_file(path)) {
+        std::cerr << "Error unknown file: \"" << path << "\"." << std::endl;
+        return std::nullopt;
+    }
+
+    report("Reading from: ", path == "-" ? "stdin" : path);
+
+    bool from_stdin = path == "-";
+    std::string name = from_stdin ? "" : build_component_name(path);
+
+    Tarball tarball;
+    if (!tarball.open(path)) {
+        return std::nullopt;
+    }
+
+    Selector selector;
+    std::set<std::string> directories;
+    Member selected[3]{}; // Symbol, footprint and 3D model
+    std::string selected_data[3];
+    std::vector<std::unique_ptr<Archive>> nested;
+
+    fs::path top_level;
+    bool single_top_level = true;
+
+    Tarball::Entry entry;
+    while (tarball.next(entry)) {
+        fs::path member(entry.name);
+
+        // Top level path part, skipping "." (e.g. tar -C dir -czf - .)
+        for (const auto& part: member) {
+            if (part != "." && part != ".." && part != "/") {
+                if (top_level.empty()) {
+                    top_level = part;
+                } else if (part != top_level) {
+                    single_top_level = false;
+                }
+                break;
+            }
         }
 
-        if (!symbol_found && item.extension() == ".lib") {
-            std::string symbol_path = item;
-            component_file_paths.symbol = convert_symbol(symbol_path);
-            symbol_found = true;
+        fs::path directory;
+        for (const auto& part: member.parent_path()) {
+            directory /= part;
+            if (directories.insert(directory.string()).second) {
+                selector.select(directory);
+            }
+        }
+
+        if (entry.directory) {
+            if (member.filename().empty()) {
+                member = member.parent_path();
+            }
+            if (directories.insert(member.string()).second) {
+                selector.select(member);
+            }
+            continue;
         }
 
-        if (!footprint_found && item.extension() == ".kicad_mod") {
-            std::cout << "Found footprint: " << item << std::endl;
-            component_file_paths.footprint = item;
-            footprint_found = true;
+        // Nested .zip files are read into memory and selected from as usual
+        if (member.extension() == ".zip" || member.extension() == ".ZIP") {
+            std::string contents;
+            auto inner = std::make_unique<Archive>();
+            if (!tarball.read(contents) ||
+                !inner->open_memory(std::move(contents))) {
+                std::cerr << "Skipping nested archive: " << member
+                          << std::endl;
+                continue;
+            }
+
+            fs::path inner_prefix = fs::path(member).replace_extension();
+            directories.insert(inner_prefix.string());
+            selector.select(inner_prefix);
+
+            select_members(*inner, inner_prefix, selector, directories,
+                           selected, nested);
+            nested.push_back(std::move(inner));
+            continue;
         }
-        if (!dmodel_found && (item.extension() == ".stp" ||
-                              item.extension() == ".step")) {
-            std::cout << "Found 3D model: " << item << std::endl;
-            component_file_paths.dmodel = item;
-            dmodel_found = true;
+
+        MemberType type = selector.select(member);
+        int slot = selection_slot(type);
+
+        if (slot >= 0) {
+            Archive::Entry member_entry{};
+            member_entry.name = entry.name;
+            selected[slot] = {type, member_entry, nullptr, ""};
+
+            if (!tarball.read(selected_data[slot])) {
+                std::cerr << "Files could not be read from: " << path
+                          << std::endl;
+                return std::nullopt;
+            }
         }
     }
 
-    return component_file_paths;
-}
+    // Named after the top level directory, or the symbol if the members
+    // aren't all inside one
+    if (name.empty() && single_top_level && !top_level.empty()) {
+        name = build_component_name(top_level);
+    } else if (name.empty() && selected[0].type != MemberType::none) {
+        name = build_component_name(
+                fs::path(selected[0].entry.name).filename());
+    }
 
-std::string Kandle::FileHandler::convert_symbol(
-        const std::string& legacy_symbol_path) {
-    Legacy legacy;
-    Symbol symbol;
-    std::string filename;
-    std::string converted_path;
-    std::string new_symbol_path;
+    if (name.empty()) {
+        std::cerr << "Unable to name the component read from stdin (no top"
+                  << " level directory or symbol)." << std::endl;
+        return std::nullopt;
+    }
 
-    converted_path = fs::path(legacy_symbol_path).parent_path();
-    converted_path += "/";
+    // Members of nested archives still need to be inflated
+    std::vector<Member> members;
+    std::vector<Member> archive_members;
+    std::vector<std::string> member_data;
+    for (int i = 0; i < 3; i++) {
+        if (selected[i].type == MemberType::none) {
+            continue;
+        }
 
-    new_symbol_path = converted_path;
-    new_symbol_path += fs::path(legacy_symbol_path).stem();
-    new_symbol_path += ".kicad_sym";
+        members.push_back(selected[i]);
+        member_data.push_back(std::move(selected_data[i]));
 
-    std::vector<std::string> lines = Utils::readlines(legacy_symbol_path);
+        if (selected[i].archive) {
+            archive_members.push_back(selected[i]);
+        }
+    }
 
-    // Parse legacy file
-    if (!legacy.convert(lines)) {
-        std::cerr << "Error converting file. Submit an issue. Exiting."
-                  << std::endl;
-        exit(1);
+    std::vector<std::string> archive_data;
+    if (!read_members(archive_members, archive_data)) {
+        std::cerr << "Files could not be read from: " << path << std::endl;
+        return std::nullopt;
+    }
+
+    for (std::size_t i = 0, j = 0; i < members.size(); i++) {
+        if (members[i].archive) {
+            member_data[i] = std::move(archive_data[j++]);
+        }
     }
 
-    // Covert legacy library to .kicad_sym in the same directory
-    if (!symbol.new_from_legacy(&legacy, new_symbol_path)) {
+    return build_file_contents(members, member_data, name);
+}
+
+/**
+ * @brief Converts selected members (already read into memory) into the
+ * form expected by the importers.
+ *
+ * @param members Selected members.
+ * @param member_data Contents of each member (same order).
+ * @param name Component name.
+ * @return Contents of the symbol, footprint and 3D model (empty if the
+ * symbol couldn't be converted).
+ */
+std::optional<Kandle::FileHandler::FileContents>
+Kandle::FileHandler::build_file_contents(
+        const std::vector<Member>& members,
+        std::vector<std::string>& member_data, const std::string& name) {
+    FileContents contents;
+    contents.name = name;
+
+    for (std::size_t i = 0; i < members.size(); i++) {
+        const Member& member = members[i];
+        std::string& data = member_data[i];
+        fs::path item = fs::path(member.directory) / member.entry.name;
+
+        switch (member.type) {
+            case MemberType::symbol:
+                report("Found symbol: ", item);
+                contents.symbol_name = item.stem();
+                contents.symbol = Utils::splitlines(data);
+                break;
+            case MemberType::legacy_symbol:
+                contents.symbol_name = item.stem();
+                if (!convert_symbol(data, name, contents.symbol)) {
+                    return std::nullopt;
+                }
+                break;
+            case MemberType::footprint:
+                report("Found footprint: ", item);
+                contents.footprint = Utils::splitlines(data);
+                break;
+            case MemberType::dmodel:
+                report("Found 3D model: ", item);
+                contents.dmodel_extension = item.extension();
+                contents.dmodel = std::move(data);
+                break;
+            default:
+                break;
+        }
+    }
+
+    return contents;
+}
+
+/**
+ * @brief Converts a legacy (.lib) symbol file in memory (no .kicad_sym is
+ * written next to it).
+ *
+ * @note The file is read whole so it is converted as -n does, components
+ * are parsed and built in parallel.
+ *
+ * @param legacy_symbol_path Path to the .lib file.
+ * @return Lines of the converted .kicad_sym file.
+ */
+std::vector<std::string> Kandle::FileHandler::convert_symbol(
+        const std::string& legacy_symbol_path) {
+    std::ifstream legacy_file(legacy_symbol_path, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(legacy_file)),
+                         std::istreambuf_iterator<char>());
+    std::vector<std::string> lines;
+
+    if (!legacy_file ||
+        !convert_symbol(contents, fs::path(legacy_symbol_path).stem(),
+                        lines)) {
         std::cerr << "Error converting file. Submit an issue. Exiting."
                   << std::endl;
         exit(1);
     }
 
-    // Get and return the new converted file path
-    for (const auto& dir_item: fs::directory_iterator{converted_path}) {
-        auto item = fs::path(dir_item);
-        if (item.extension() == ".kicad_sym") {
-            return item;
-        }
+    return lines;
+}
+
+/**
+ * @brief Converts a legacy (.lib) symbol that has been read into memory,
+ * the converted symbol never touches the disk.
+ *
+ * @param legacy_contents Contents of the .lib file.
+ * @param name Component name.
+ * @param lines Lines of the converted .kicad_sym file.
+ * @return True if the symbol was converted (reported if not).
+ */
+bool Kandle::FileHandler::convert_symbol(const std::string& legacy_contents,
+                                         const std::string& name,
+                                         std::vector<std::string>& lines) {
+    Legacy legacy;
+    Symbol symbol;
+    std::string converted;
+
+    if (!legacy.convert(legacy_contents) ||
+        !symbol.render(&legacy, converted)) {
+        std::cerr << "Error converting " << name << ". Submit an issue."
+                  << std::endl;
+        return false;
     }
 
-    std::cerr << "Error converting file. Submit an issue. Exiting."
-              << std::endl;
+    lines = Utils::splitlines(converted);
 
-    exit(1);
+    return true;
 }
 
 /**
@@ -228,24 +813,40 @@ void Kandle::FileHandler::substitute_footprint(std::string& line) {
     footprint_path += R"("Footprint" ")";
     footprint_path += fs::path(library_file_paths.symbol).stem();
     footprint_path += ":";
-    footprint_path += fs::path(output_directory).filename();
+    footprint_path += component_name;
     footprint_path += R"(")";
 
     line = std::regex_replace(line, re, footprint_path);
 }
 
-bool Kandle::FileHandler::new_symbol_library(const std::string& path) {
-    std::vector<std::string> lines = Utils::readlines(path);
+// Reads an existing symbol library (if there is one) into memory
+void Kandle::FileHandler::open_symbol_library(SymbolLibrary& library) {
+    library.exists = fs::exists(library_file_paths.symbol);
 
-    // Create new file
-    std::cout << "Creating new symbol library: "
-              << library_file_paths.symbol << std::endl;
+    if (library.exists) {
+        library.lines = Utils::readlines(library_file_paths.symbol);
+    }
+}
 
-    std::fstream symbol_file(library_file_paths.symbol,
-                             std::fstream::out | std::fstream::app);
+/**
+ * @brief Merges a symbol into a symbol library held in memory (see
+ * write_symbol_library).
+ *
+ * @param library Symbol library.
+ * @param symbol_name Name used to check if the symbol is already in the
+ * library.
+ * @param lines Lines of the .kicad_sym file.
+ * @return True if the symbol was merged (or already exists).
+ */
+bool Kandle::FileHandler::merge_symbol(SymbolLibrary& library,
+                                       const std::string& symbol_name,
+                                       std::vector<std::string>& lines) {
 
+    // Library doesn't exist so the symbol becomes the library
+    if (!library.exists) {
+        std::cout << "Creating new symbol library: "
+                  << library_file_paths.symbol << std::endl;
 
-    if (symbol_file.is_open()) {
         for (auto& line: lines) {
             if (std::empty(line)) {
                 continue;
@@ -256,32 +857,22 @@ bool Kandle::FileHandler::new_symbol_library(const std::string& path) {
                 substitute_footprint(line);
             }
 
-            symbol_file << line << "\n";
+            library.lines.push_back(line);
         }
-        symbol_file.close();
-    } else {
-        return false;
-    }
 
-    return true;
-}
-
-bool Kandle::FileHandler::append_to_symbol_library(const std::string& path) {
-
-    std::vector<std::string> lines = Utils::readlines(path);
-
-    // Append to existing file
-    std::vector<std::string> existing_lines = Utils::readlines(
-            library_file_paths.symbol);
+        library.exists = true;
+        library.modified = true;
+        return true;
+    }
 
     long line_number = 0;
     bool valid_library = false;
-    for (const auto& line: existing_lines) {
+    for (const auto& line: library.lines) {
         if (line.find("(kicad_symbol_lib") != std::string::npos) {
             valid_library = true;
         }
 
-        if (line.find(fs::path(path).stem()) != std::string::npos) {
+        if (line.find(symbol_name) != std::string::npos) {
             std::cout << "Component already exists in symbol library."
                       << std::endl;
             return true;
@@ -324,27 +915,41 @@ bool Kandle::FileHandler::append_to_symbol_library(const std::string& path) {
         index++;
     }
 
-    // Append the contents of the symbol to the existing symbol library under
-    // the line containing "kicad_symbol_lib"
-    existing_lines.insert((existing_lines.begin() + line_number + 1),
-                          lines.begin() + symbol_header + 1,
-                          lines.end() - (long) (lines.size() - symbol_footer));
+    // Insert the contents of the symbol under the line containing
+    // "kicad_symbol_lib"
+    library.lines.insert((library.lines.begin() + line_number + 1),
+                         lines.begin() + symbol_header + 1,
+                         lines.end() - (long) (lines.size() - symbol_footer));
+    library.modified = true;
 
-    // Write the appended contents back to the file (overwrites)
-    std::fstream symbol_file(library_file_paths.symbol, std::fstream::out);
-    if (symbol_file.is_open()) {
-        for (const auto& line: existing_lines) {
-            // Ignore empty lines
-            if (!std::empty(line)) {
-                symbol_file << line << "\n";
-            }
+    return true;
+}
+
+// Writes the symbol library back to the file (once, after merging)
+bool Kandle::FileHandler::write_symbol_library(const SymbolLibrary& library) {
+    if (!library.modified) {
+        return true;
+    }
+
+    std::string contents;
+    for (const auto& line: library.lines) {
+        // Ignore empty lines
+        if (!std::empty(line)) {
+            contents += line;
+            contents += '\n';
         }
-        symbol_file.close();
-    } else {
+    }
+
+    std::ofstream symbol_file(library_file_paths.symbol,
+                              std::ios::out | std::ios::binary);
+    if (!symbol_file.is_open()) {
         return false;
     }
 
-    return true;
+    symbol_file.write(contents.data(), (std::streamsize) contents.size());
+    symbol_file.close();
+
+    return (bool) symbol_file;
 }
 
 bool Kandle::FileHandler::import_symbol(const std::string& path) {
@@ -354,13 +959,67 @@ bool Kandle::FileHandler::import_symbol(const std::string& path) {
         return false;
     }
 
-    // Library doesn't exist so create one
-    if (!fs::exists(library_file_paths.symbol)) {
-        return new_symbol_library(path);
+    // Legacy symbols are converted in memory
+    std::vector<std::string> lines = fs::path(path).extension() == ".lib" ?
+                                     convert_symbol(path) :
+                                     Utils::readlines(path);
+
+    return import_symbol(fs::path(path).stem(), lines);
+}
+
+/**
+ * @brief Imports a symbol (already in memory) into the symbol library.
+ *
+ * @param symbol_name Name used to check if the symbol is already in the
+ * library.
+ * @param lines Lines of the .kicad_sym file.
+ * @return True if the symbol was imported (or already exists).
+ */
+bool Kandle::FileHandler::import_symbol(const std::string& symbol_name,
+                                        std::vector<std::string>& lines) {
+
+    // Symbol not found (probably not in the .zip file)
+    if (std::empty(lines)) {
+        return false;
     }
 
-    // Append to existing symbol library
-    return append_to_symbol_library(path);
+    SymbolLibrary library;
+    open_symbol_library(library);
+
+    return merge_symbol(library, symbol_name, lines) &&
+           write_symbol_library(library);
+}
+
+/**
+ * @brief Imports components (already in memory) into a library. Symbols are
+ * merged in memory so the symbol library is only read and written once.
+ *
+ * @param library_name Name of the library the components belong to.
+ * @param components Contents of each component (imported in order).
+ * @return True if every symbol was imported and the library written.
+ */
+bool Kandle::FileHandler::import_components(
+        const std::string& library_name,
+        std::vector<FileContents>& components) {
+    SymbolLibrary library;
+    bool success = true;
+
+    build_library_paths(library_name);
+    open_symbol_library(library);
+
+    for (auto& contents: components) {
+        component_name = contents.name;
+
+        if (!std::empty(contents.symbol) &&
+            !merge_symbol(library, contents.symbol_name, contents.symbol)) {
+            success = false;
+        }
+
+        import_footprint(contents.footprint);
+        import_3dmodel(contents.dmodel, contents.dmodel_extension);
+    }
+
+    return write_symbol_library(library) && success;
 }
 
 void Kandle::FileHandler::straight_copy(const std::string& source,
@@ -402,28 +1061,41 @@ void Kandle::FileHandler::constrain_footprint_text(std::string& line) {
 
 bool Kandle::FileHandler::import_footprint(const std::string& path) {
 
-    std::string component_path;
-
     // No footprint library found
     if (std::empty(path)) {
         return false;
     }
 
+    return import_footprint(Utils::readlines(path));
+}
+
+/**
+ * @brief Writes a footprint (already in memory) into the footprint library,
+ * constraining the size of its text.
+ *
+ * @param lines Lines of the .kicad_mod file.
+ * @return True if the footprint was written.
+ */
+bool Kandle::FileHandler::import_footprint(
+        const std::vector<std::string>& lines) {
+
+    std::string component_path;
+
+    // No footprint found
+    if (std::empty(lines)) {
+        return false;
+    }
+
     // Create library directory if it doesn't exist
     if (!exists(fs::path(library_file_paths.footprint))) {
         fs::create_directories(library_file_paths.footprint);
     }
 
-    std::vector<std::string> lines = Utils::readlines(path);
-
     component_path += library_file_paths.footprint;
     component_path += "/";
-    component_path += fs::path(output_directory).filename();
+    component_path += component_name;
     component_path += ".kicad_mod";
 
-    straight_copy(path, component_path);
-
-    // Open newly copied files
     std::fstream footprint_file(component_path, std::fstream::out);
 
     if (!footprint_file.is_open()) {
@@ -432,7 +1104,7 @@ bool Kandle::FileHandler::import_footprint(const std::string& path) {
     }
 
     // Find font and replace font size
-    for (auto& line : lines) {
+    for (auto line : lines) {
       if (std::empty(line)) {
         continue;
       }
@@ -466,7 +1138,7 @@ bool Kandle::FileHandler::import_3dmodel(const std::string& path) {
 
     component_path += library_file_paths.dmodel;
     component_path += "/";
-    component_path += fs::path(output_directory).filename();
+    component_path += component_name;
     component_path += fs::path(path).extension();
 
     straight_copy(path, component_path);
@@ -474,5 +1146,42 @@ bool Kandle::FileHandler::import_3dmodel(const std::string& path) {
     return true;
 }
 
+/**
+ * @brief Writes a 3D model (already in memory) into the 3D model library.
+ *
+ * @param contents Contents of the .stp/.step file.
+ * @param extension Extension of the original file (.stp or .step).
+ * @return True if the 3D model was written.
+ */
+bool Kandle::FileHandler::import_3dmodel(const std::string& contents,
+                                         const std::string& extension) {
 
+    std::string component_path;
 
+    // No 3dmodel found
+    if (std::empty(extension)) {
+        return false;
+    }
+
+    // Create library directory if it doesn't exist
+    if (!exists(fs::path(library_file_paths.dmodel))) {
+        fs::create_directories(library_file_paths.dmodel);
+    }
+
+    component_path += library_file_paths.dmodel;
+    component_path += "/";
+    component_path += component_name;
+    component_path += extension;
+
+    std::ofstream dest_file(component_path, std::ios::binary);
+
+    if (!dest_file) {
+        std::cerr << "Unable to write to file: " << component_path
+                  << std::endl;
+        exit(1);
+    }
+
+    dest_file.write(contents.data(), (std::streamsize) contents.size());
+
+    return true;
+}
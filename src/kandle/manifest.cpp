@@ -0,0 +1,401 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Harvey Bates
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "kandle/manifest.h"
+
+namespace fs = std::filesystem;
+
+/**
+ * @brief Reads a manifest (.csv or .json). Files are grouped by library, in
+ * the order each library first appears.
+ *
+ * @param path Path to the manifest.
+ * @param libraries Libraries and the files to import into each.
+ * @return True if the manifest was read.
+ */
+bool Kandle::Manifest::read(const std::string& path,
+                            std::vector<Library>& libraries) {
+    std::ifstream file(path, std::ios::binary);
+
+    if (!file) {
+        std::cerr << "Manifest: " << path << " not found." << std::endl;
+        return false;
+    }
+
+    std::string contents((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+
+    libraries.clear();
+
+    bool parsed = fs::path(path).extension() == ".json" ?
+                  parse_json(contents, libraries) :
+                  parse_csv(contents, libraries);
+
+    if (!parsed) {
+        std::cerr << "Invalid manifest: " << path << std::endl;
+        return false;
+    }
+
+    // Relative paths are relative to the manifest, not the project
+    fs::path directory = fs::path(path).parent_path();
+    for (auto& library: libraries) {
+        for (auto& filename: library.files) {
+            if (fs::path(filename).is_relative()) {
+                filename = (directory / filename).lexically_normal();
+            }
+        }
+    }
+
+    return true;
+}
+
+void Kandle::Manifest::add(std::vector<Library>& libraries,
+                           const std::string& library,
+                           const std::string& file) {
+    for (auto& existing: libraries) {
+        if (existing.name == library) {
+            existing.files.push_back(file);
+            return;
+        }
+    }
+
+    libraries.push_back({library, {file}});
+}
+
+// Removes surrounding whitespace (including the '\r' of CRLF files)
+static std::string trim(const std::string& field) {
+    std::size_t start = field.find_first_not_of(" \t\r");
+    if (start == std::string::npos) {
+        return "";
+    }
+
+    return field.substr(start, field.find_last_not_of(" \t\r") - start + 1);
+}
+
+// Splits a CSV record, "quoted fields" may contain commas and "" for a quote
+static std::vector<std::string> split_record(const std::string& line) {
+    std::vector<std::string> fields(1);
+    bool quoted = false;
+
+    for (std::size_t i = 0; i < line.size(); i++) {
+        char c = line[i];
+
+        if (quoted) {
+            if (c != '"') {
+                fields.back() += c;
+            } else if (i + 1 < line.size() && line[i + 1] == '"') {
+                fields.back() += '"';
+                i++;
+            } else {
+                quoted = false;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.emplace_back();
+        } else {
+            fields.back() += c;
+        }
+    }
+
+    for (auto& field: fields) {
+        field = trim(field);
+    }
+
+    return fields;
+}
+
+/**
+ * @brief Parses file,library records. Empty lines, comments (lines beginning
+ * with '#') and a file,library header are skipped.
+ */
+bool Kandle::Manifest::parse_csv(const std::string& contents,
+                                 std::vector<Library>& libraries) {
+    std::istringstream stream(contents);
+    std::string line;
+    int line_number = 0;
+
+    while (std::getline(stream, line)) {
+        line_number++;
+
+        if (trim(line).empty() || line.at(0) == '#') {
+            continue;
+        }
+
+        std::vector<std::string> fields = split_record(line);
+
+        if (fields.size() < 2 || fields[0].empty() || fields[1].empty()) {
+            std::cerr << "Expected file,library on line " << line_number
+                      << "." << std::endl;
+            return false;
+        }
+
+        if (fields[0] == "file" && fields[1] == "library") {
+            continue;
+        }
+
+        add(libraries, fields[1], fields[0]);
+    }
+
+    return true;
+}
+
+// Just enough JSON to read a manifest (objects, arrays and strings)
+
+static void skip_space(const std::string& text, std::size_t& pos) {
+    while (pos < text.size() && std::isspace((unsigned char) text[pos])) {
+        pos++;
+    }
+}
+
+static bool consume(const std::string& text, std::size_t& pos, char c) {
+    skip_space(text, pos);
+
+    if (pos < text.size() && text[pos] == c) {
+        pos++;
+        return true;
+    }
+
+    return false;
+}
+
+static void append_utf8(std::string& value, uint32_t code_point) {
+    if (code_point < 0x80) {
+        value += (char) code_point;
+    } else if (code_point < 0x800) {
+        value += (char) (0xC0 | (code_point >> 6));
+        value += (char) (0x80 | (code_point & 0x3F));
+    } else if (code_point < 0x10000) {
+        value += (char) (0xE0 | (code_point >> 12));
+        value += (char) (0x80 | ((code_point >> 6) & 0x3F));
+        value += (char) (0x80 | (code_point & 0x3F));
+    } else {
+        value += (char) (0xF0 | (code_point >> 18));
+        value += (char) (0x80 | ((code_point >> 12) & 0x3F));
+        value += (char) (0x80 | ((code_point >> 6) & 0x3F));
+        value += (char) (0x80 | (code_point & 0x3F));
+    }
+}
+
+static bool parse_hex(const std::string& text, std::size_t& pos,
+                      uint32_t& value) {
+    if (pos + 4 > text.size()) {
+        return false;
+    }
+
+    value = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = text[pos++];
+        value <<= 4;
+        if (c >= '0' && c <= '9') {
+            value |= (uint32_t) (c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            value |= (uint32_t) (c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+            value |= (uint32_t) (c - 'A' + 10);
+        } else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool parse_string(const std::string& text, std::size_t& pos,
+                         std::string& value) {
+    if (!consume(text, pos, '"')) {
+        return false;
+    }
+
+    value.clear();
+    while (pos < text.size()) {
+        char c = text[pos++];
+
+        if (c == '"') {
+            return true;
+        }
+
+        if (c != '\\') {
+            value += c;
+            continue;
+        }
+
+        if (pos >= text.size()) {
+            return false;
+        }
+
+        switch (text[pos++]) {
+            case '"':
+                value += '"';
+                break;
+            case '\\':
+                value += '\\';
+                break;
+            case '/':
+                value += '/';
+                break;
+            case 'b':
+                value += '\b';
+                break;
+            case 'f':
+                value += '\f';
+                break;
+            case 'n':
+                value += '\n';
+                break;
+            case 'r':
+                value += '\r';
+                break;
+            case 't':
+                value += '\t';
+                break;
+            case 'u': {
+                uint32_t code_point;
+                if (!parse_hex(text, pos, code_point)) {
+                    return false;
+                }
+
+                // Characters outside the BMP are escaped as surrogate pairs
+                uint32_t low;
+                if (code_point >= 0xD800 && code_point < 0xDC00 &&
+                    text.compare(pos, 2, "\\u") == 0) {
+                    pos += 2;
+                    if (!parse_hex(text, pos, low)) {
+                        return false;
+                    }
+                    code_point = 0x10000 + ((code_point - 0xD800) << 10) +
+                                 (low - 0xDC00);
+                }
+
+                append_utf8(value, code_point);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Parses either a list of {"file": ..., "library": ...} objects or
+ * an object of libraries, each with a list of files.
+ */
+bool Kandle::Manifest::parse_json(const std::string& text,
+                                  std::vector<Library>& libraries) {
+    std::size_t pos = 0;
+    bool valid = false;
+
+    if (consume(text, pos, '[')) {
+        valid = consume(text, pos, ']');
+
+        while (!valid && consume(text, pos, '{')) {
+            std::string file;
+            std::string library;
+
+            bool closed = consume(text, pos, '}');
+            while (!closed) {
+                std::string key;
+                std::string value;
+                if (!parse_string(text, pos, key) ||
+                    !consume(text, pos, ':') ||
+                    !parse_string(text, pos, value)) {
+                    break;
+                }
+
+                if (key == "file") {
+                    file = value;
+                } else if (key == "library") {
+                    library = value;
+                }
+
+                if (!consume(text, pos, ',')) {
+                    closed = consume(text, pos, '}');
+                    break;
+                }
+            }
+
+            if (!closed || file.empty() || library.empty()) {
+                break;
+            }
+
+            add(libraries, library, file);
+
+            if (!consume(text, pos, ',')) {
+                valid = consume(text, pos, ']');
+                break;
+            }
+        }
+    } else if (consume(text, pos, '{')) {
+        valid = consume(text, pos, '}');
+
+        std::string library;
+        while (!valid && parse_string(text, pos, library) &&
+               consume(text, pos, ':')) {
+            std::string file;
+
+            if (library.empty()) {
+                break;
+            }
+
+            if (!consume(text, pos, '[')) {
+                if (!parse_string(text, pos, file) || file.empty()) {
+                    break;
+                }
+                add(libraries, library, file);
+            } else if (!consume(text, pos, ']')) {
+                // Every comma must be followed by another file (no
+                // trailing comma)
+                bool listed;
+                do {
+                    listed = parse_string(text, pos, file) && !file.empty();
+                    if (listed) {
+                        add(libraries, library, file);
+                    }
+                } while (listed && consume(text, pos, ','));
+
+                if (!listed || !consume(text, pos, ']')) {
+                    break;
+                }
+            }
+
+            if (!consume(text, pos, ',')) {
+                valid = consume(text, pos, '}');
+                break;
+            }
+        }
+    }
+
+    skip_space(text, pos);
+
+    if (!valid || pos != text.size()) {
+        long line = std::count(text.begin(), text.begin() + (long) pos,
+                               '\n') + 1;
+        std::cerr << "Unexpected JSON on line " << line << "." << std::endl;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,294 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2023 Harvey Bates
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "kandle/tarball.h"
+
+// Header fields (POSIX ustar)
+static const std::size_t NAME_OFFSET = 0;
+static const std::size_t NAME_SIZE = 100;
+static const std::size_t SIZE_OFFSET = 124;
+static const std::size_t SIZE_SIZE = 12;
+static const std::size_t CHECKSUM_OFFSET = 148;
+static const std::size_t CHECKSUM_SIZE = 8;
+static const std::size_t TYPE_OFFSET = 156;
+static const std::size_t MAGIC_OFFSET = 257;
+static const std::size_t PREFIX_OFFSET = 345;
+static const std::size_t PREFIX_SIZE = 155;
+
+// Type flags
+static const char TYPE_FILE = '0';
+static const char TYPE_FILE_OLD = '\0';
+static const char TYPE_DIRECTORY = '5';
+static const char TYPE_GNU_LONG_NAME = 'L';
+static const char TYPE_PAX_HEADER = 'x';
+
+// Long names (GNU or pax) larger than this are rejected
+static const uint64_t MAX_NAME_SIZE = 4096;
+
+Kandle::Tarball::~Tarball() {
+    if (file) {
+        gzclose(file);
+    }
+}
+
+/**
+ * @brief Opens a tarball for reading.
+ *
+ * @param path Path to the .tar.gz/.tgz file or "-" for stdin.
+ * @return True if the file was opened.
+ */
+bool Kandle::Tarball::open(const std::string& path) {
+    if (path == "-") {
+        int fd = dup(STDIN_FILENO);
+        file = fd < 0 ? nullptr : gzdopen(fd, "rb");
+    } else {
+        file = gzopen(path.c_str(), "rb");
+    }
+
+    if (!file) {
+        std::cerr << "Unable to open tarball: " << path << std::endl;
+        return false;
+    }
+
+    gzbuffer(file, 128 * 1024);
+
+    return true;
+}
+
+bool Kandle::Tarball::is_tarball(const std::string& path) {
+    auto ends_with = [&](const std::string& suffix) {
+        return path.size() >= suffix.size() &&
+               path.compare(path.size() - suffix.size(), suffix.size(),
+                            suffix) == 0;
+    };
+
+    return path == "-" || ends_with(".tar.gz") || ends_with(".tgz");
+}
+
+bool Kandle::Tarball::read_block(char* block) {
+    return gzread(file, block, BLOCK_SIZE) == (int) BLOCK_SIZE;
+}
+
+// Skips forward by reading (stdin can't seek)
+bool Kandle::Tarball::skip(uint64_t length) {
+    char scratch[16384];
+
+    while (length > 0) {
+        auto chunk = (unsigned) std::min<uint64_t>(length, sizeof(scratch));
+        if (gzread(file, scratch, chunk) != (int) chunk) {
+            return false;
+        }
+        length -= chunk;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Parses a numeric header field, either octal text or (GNU) base-256
+ * for large values.
+ */
+uint64_t Kandle::Tarball::parse_size(const char* field, std::size_t length) {
+    uint64_t value = 0;
+
+    if ((unsigned char) field[0] & 0x80) {
+        for (std::size_t i = 1; i < length; i++) {
+            value = (value << 8) | (unsigned char) field[i];
+        }
+        return value;
+    }
+
+    for (std::size_t i = 0; i < length; i++) {
+        if (field[i] >= '0' && field[i] <= '7') {
+            value = (value << 3) | (uint64_t) (field[i] - '0');
+        } else if (field[i] != ' ' || value != 0) {
+            break;
+        }
+    }
+
+    return value;
+}
+
+// The checksum is the sum of the header bytes, with the checksum as spaces
+bool Kandle::Tarball::valid_checksum(const char* block) {
+    uint64_t sum = 0;
+
+    for (std::size_t i = 0; i < BLOCK_SIZE; i++) {
+        if (i >= CHECKSUM_OFFSET && i < CHECKSUM_OFFSET + CHECKSUM_SIZE) {
+            sum += ' ';
+        } else {
+            sum += (unsigned char) block[i];
+        }
+    }
+
+    return sum == parse_size(block + CHECKSUM_OFFSET, CHECKSUM_SIZE);
+}
+
+/**
+ * @brief Finds the path in a pax extended header.
+ *
+ * @example "30 path=some/very/long/name\n"
+ */
+std::string Kandle::Tarball::pax_path(const std::string& records) {
+    std::size_t pos = 0;
+
+    while (pos < records.size()) {
+        std::size_t space = records.find(' ', pos);
+        if (space == std::string::npos) {
+            break;
+        }
+
+        std::size_t length = std::strtoul(records.c_str() + pos, nullptr, 10);
+        if (length == 0 || pos + length > records.size()) {
+            break;
+        }
+
+        std::string record = records.substr(space + 1,
+                                            pos + length - space - 2);
+        if (record.compare(0, 5, "path=") == 0) {
+            return record.substr(5);
+        }
+
+        pos += length;
+    }
+
+    return "";
+}
+
+/**
+ * @brief Advances to the next file or directory in the tarball, skipping
+ * whatever is left of the current member.
+ *
+ * @param entry Next file or directory.
+ * @return False at the end of the tarball (or on error).
+ */
+bool Kandle::Tarball::next(Entry& entry) {
+    char block[BLOCK_SIZE];
+    std::string long_name;
+
+    if (!skip(remaining + padding)) {
+        return false;
+    }
+    remaining = 0;
+    padding = 0;
+
+    while (read_block(block)) {
+        // End of archive is marked by zeroed blocks
+        if (block[0] == '\0') {
+            return false;
+        }
+
+        if (!valid_checksum(block)) {
+            std::cerr << "Invalid tarball header." << std::endl;
+            return false;
+        }
+
+        uint64_t size = parse_size(block + SIZE_OFFSET, SIZE_SIZE);
+        remaining = size;
+        padding = (BLOCK_SIZE - size % BLOCK_SIZE) % BLOCK_SIZE;
+        char type = block[TYPE_OFFSET];
+
+        // Long names apply to the following header
+        if (type == TYPE_GNU_LONG_NAME || type == TYPE_PAX_HEADER) {
+            std::string contents;
+            if (size > MAX_NAME_SIZE || !read(contents)) {
+                return false;
+            }
+
+            if (type == TYPE_GNU_LONG_NAME) {
+                long_name = contents.c_str();
+            } else {
+                long_name = pax_path(contents);
+            }
+
+            if (!skip(padding)) {
+                return false;
+            }
+            padding = 0;
+            continue;
+        }
+
+        if (type != TYPE_FILE && type != TYPE_FILE_OLD &&
+            type != TYPE_DIRECTORY) {
+            // Links, devices etc. are skipped
+            if (!skip(remaining + padding)) {
+                return false;
+            }
+            remaining = 0;
+            padding = 0;
+            long_name.clear();
+            continue;
+        }
+
+        if (!long_name.empty()) {
+            entry.name = long_name;
+        } else {
+            entry.name.assign(block + NAME_OFFSET,
+                              strnlen(block + NAME_OFFSET, NAME_SIZE));
+
+            if (memcmp(block + MAGIC_OFFSET, "ustar", 5) == 0 &&
+                block[PREFIX_OFFSET] != '\0') {
+                std::string prefix(block + PREFIX_OFFSET,
+                                   strnlen(block + PREFIX_OFFSET,
+                                           PREFIX_SIZE));
+                entry.name = prefix + "/" + entry.name;
+            }
+        }
+
+        entry.size = size;
+        entry.directory = type == TYPE_DIRECTORY ||
+                          (!entry.name.empty() && entry.name.back() == '/');
+
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Reads the (rest of the) current member into memory.
+ *
+ * @note The size in the header isn't trusted, the buffer grows as data is
+ * actually read. A truncated (or crafted) tarball can't force a large
+ * allocation up front.
+ *
+ * @param contents Contents of the member.
+ * @return True if the whole member was read.
+ */
+bool Kandle::Tarball::read(std::string& contents) {
+    contents.clear();
+
+    while (remaining > 0) {
+        auto chunk = (unsigned) std::min<uint64_t>(remaining, READ_SIZE);
+        std::size_t start = contents.size();
+
+        contents.resize(start + chunk);
+        if (gzread(file, &contents[start], chunk) != (int) chunk) {
+            return false;
+        }
+        remaining -= chunk;
+    }
+
+    return true;
+}
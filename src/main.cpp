@@ -23,9 +23,83 @@
  */
 
 #include <iostream>
+#include <optional>
+#include <glob.h>
+
+// File names may contain commas (the default delimiter for -f)
+#define CXXOPTS_VECTOR_DELIMITER '\0'
+
 #include <cxxopts.hpp>
 #include "kandle/filestructure.h"
 #include "kandle/filehandler.h"
+#include "kandle/manifest.h"
+
+/**
+ * @brief Expands any glob patterns the shell didn't (e.g. -f "*.zip"), so
+ * quoted patterns also work.
+ *
+ * @param filenames File names and/or patterns.
+ * @return File names (patterns are replaced by their sorted matches).
+ */
+static std::vector<std::string> expand_filenames(
+        const std::vector<std::string>& filenames) {
+    std::vector<std::string> expanded;
+
+    for (const auto& filename: filenames) {
+        if (filename.find_first_of("*?[") == std::string::npos) {
+            expanded.push_back(filename);
+            continue;
+        }
+
+        glob_t matches;
+        if (glob(filename.c_str(), 0, nullptr, &matches) != 0) {
+            std::cerr << "No files match: \"" << filename << "\". Exiting."
+                      << std::endl;
+            exit(1);
+        }
+
+        for (std::size_t i = 0; i < matches.gl_pathc; i++) {
+            expanded.emplace_back(matches.gl_pathv[i]);
+        }
+        globfree(&matches);
+    }
+
+    return expanded;
+}
+
+/**
+ * @brief Imports the component files that were loaded into a library. Files
+ * that couldn't be loaded (already reported) are skipped.
+ *
+ * @param library_name Name of the library.
+ * @param loaded Contents of each file (empty if it wasn't loaded).
+ * @return True if every file was loaded and imported.
+ */
+static bool import_loaded(
+        const std::string& library_name,
+        std::vector<std::optional<Kandle::FileHandler::FileContents>>& loaded) {
+    std::vector<Kandle::FileHandler::FileContents> components;
+
+    for (auto& contents: loaded) {
+        if (contents) {
+            components.push_back(std::move(*contents));
+        }
+    }
+
+    std::size_t skipped = loaded.size() - components.size();
+    if (skipped > 0) {
+        std::cerr << "Skipped " << skipped << " of " << loaded.size()
+                  << " files for " << library_name << "." << std::endl;
+    }
+
+    if (components.empty()) {
+        return false;
+    }
+
+    return Kandle::FileHandler::import_components(library_name,
+                                                  components) &&
+           skipped == 0;
+}
 
 int main(int argc, char** argv) {
     cxxopts::Options options("Kandle",
@@ -39,15 +113,36 @@ int main(int argc, char** argv) {
              cxxopts::value<bool>())
 
             ("f,filename", "Path to zipped (.zip) component file (from "
-                           "symbol vendors).",
-             cxxopts::value<std::string>())
+                           "symbol vendors). Also accepts .tar.gz/.tgz "
+                           "files or \"-\" to read a .tar.gz from stdin. "
+                           "Repeat (or use a glob) to import several "
+                           "files at once.",
+             cxxopts::value<std::vector<std::string>>())
 
             ("l,library", "Name of the library the component belongs to. "
                           "E.g. op-amps for an LM358 IC.",
              cxxopts::value<std::string>())
 
+            ("a,extract-all", "Extract every file in the component file "
+                              "(not just the symbol, footprint and 3D "
+                              "model).",
+             cxxopts::value<bool>())
+
+            ("n,no-extract", "Import directly from the component file "
+                             "without extracting it to "
+                             "components/extern/tmp.",
+             cxxopts::value<bool>())
+
+            ("m,manifest", "CSV or JSON file listing component files and "
+                           "the library each belongs to (imported in "
+                           "bulk).",
+             cxxopts::value<std::string>())
+
             ("h,help", "Display help information.");
 
+    // Extra file names (e.g. from -f *.zip) are imported as well
+    options.parse_positional({"filename"});
+
     auto result = options.parse(argc, argv);
 
     if (result.count("help")) {
@@ -67,6 +162,41 @@ int main(int argc, char** argv) {
         exit(0);
     }
 
+    if (result.count("manifest")) {
+        std::vector<Kandle::Manifest::Library> libraries;
+        if (!Kandle::Manifest::read(result["manifest"].as<std::string>(),
+                                    libraries)) {
+            exit(1);
+        }
+
+        // Every file (of every library) is loaded in one parallel pass, then
+        // each library is written once
+        std::vector<std::string> files;
+        for (const auto& library: libraries) {
+            files.insert(files.end(), library.files.begin(),
+                         library.files.end());
+        }
+
+        std::vector<std::optional<Kandle::FileHandler::FileContents>> loaded =
+                Kandle::FileHandler::load(files);
+
+        bool success = true;
+        auto first = loaded.begin();
+        for (const auto& library: libraries) {
+            auto last = first + (long) library.files.size();
+            std::vector<std::optional<Kandle::FileHandler::FileContents>>
+                    library_loaded(std::make_move_iterator(first),
+                                   std::make_move_iterator(last));
+            first = last;
+
+            if (!import_loaded(library.name, library_loaded)) {
+                success = false;
+            }
+        }
+
+        return success ? 0 : 1;
+    }
+
     if (!result.count("library")) {
         std::cerr << "Library not provided. "
                      "A valid library name must be provided "
@@ -86,11 +216,28 @@ int main(int argc, char** argv) {
         exit(1);
     }
 
-    std::string filename;
     std::string library_name = result["library"].as<std::string>();
+    std::vector<std::string> filenames = expand_filenames(
+            result["filename"].as<std::vector<std::string>>());
+    std::string filename = filenames.front();
+
+    // Tarballs are always read in a single pass, straight into memory. So
+    // are batches, which are read in parallel then written to the library
+    // once.
+    if (filenames.size() > 1 || result.count("no-extract") ||
+        Kandle::Tarball::is_tarball(filename)) {
+        if (filenames.size() > 1 && result.count("extract-all")) {
+            std::cout << "Ignoring --extract-all (several files given)."
+                      << std::endl;
+        }
+
+        std::vector<std::optional<Kandle::FileHandler::FileContents>> loaded =
+                Kandle::FileHandler::load(filenames);
+
+        return import_loaded(library_name, loaded) ? 0 : 1;
+    }
 
-    filename = result["filename"].as<std::string>();
-    Kandle::FileHandler::unzip(filename);
+    Kandle::FileHandler::unzip(filename, !result.count("extract-all"));
 
     Kandle::FileHandler::FilePaths files =
             Kandle::FileHandler::recursive_extract_paths(library_name);
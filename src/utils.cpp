@@ -58,6 +58,177 @@ std::vector<std::string> Utils::readlines(
     return lines;
 }
 
+/**
+ * @brief Splits the contents of a file (already in memory) into lines, the
+ * same way readlines() does.
+ *
+ * @note Comments are ommitted (lines beginning with '#')
+ *
+ * @param contents Contents of a lib or footprint file.
+ * @return Vector of strings representing individual lines.
+ */
+std::vector<std::string> Utils::splitlines(const std::string& contents) {
+
+    std::vector<std::string> lines;
+    std::size_t pos = 0;
+
+    while (pos < contents.size()) {
+        std::size_t end = contents.find('\n', pos);
+        if (end == std::string::npos) {
+            end = contents.size();
+        }
+
+        if (end > pos && contents[pos] != '#') {
+            lines.emplace_back(contents, pos, end - pos);
+        }
+
+        pos = end + 1;
+    }
+
+    return lines;
+}
+
+static const uint64_t XXH_PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t XXH_PRIME64_3 = 0x165667B19E3779F9ULL;
+static const uint64_t XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t XXH_PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+static uint64_t xxh_rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static uint64_t xxh_read64(const char* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v; // Assumes a little endian host
+}
+
+static uint32_t xxh_read32(const char* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint64_t xxh_round(uint64_t acc, uint64_t input) {
+    acc += input * XXH_PRIME64_2;
+    acc = xxh_rotl(acc, 31);
+    return acc * XXH_PRIME64_1;
+}
+
+static uint64_t xxh_merge_round(uint64_t acc, uint64_t val) {
+    acc ^= xxh_round(0, val);
+    return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+/**
+ * @brief 64-bit xxHash (XXH64) of a block of memory. Used to tell if a
+ * vendor archive has changed without comparing its contents.
+ *
+ * @param data Start of the block.
+ * @param length Length of the block in bytes.
+ * @param seed Optional seed.
+ * @return Hash of the block.
+ */
+uint64_t Utils::xxhash64(const char* data, std::size_t length,
+                         uint64_t seed) {
+    const char* p = data;
+    const char* end = data + length;
+    uint64_t h;
+
+    if (length >= 32) {
+        uint64_t v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+        uint64_t v2 = seed + XXH_PRIME64_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - XXH_PRIME64_1;
+
+        do {
+            v1 = xxh_round(v1, xxh_read64(p));
+            v2 = xxh_round(v2, xxh_read64(p + 8));
+            v3 = xxh_round(v3, xxh_read64(p + 16));
+            v4 = xxh_round(v4, xxh_read64(p + 24));
+            p += 32;
+        } while (p + 32 <= end);
+
+        h = xxh_rotl(v1, 1) + xxh_rotl(v2, 7) + xxh_rotl(v3, 12) +
+            xxh_rotl(v4, 18);
+        h = xxh_merge_round(h, v1);
+        h = xxh_merge_round(h, v2);
+        h = xxh_merge_round(h, v3);
+        h = xxh_merge_round(h, v4);
+    } else {
+        h = seed + XXH_PRIME64_5;
+    }
+
+    h += (uint64_t) length;
+
+    while (p + 8 <= end) {
+        h ^= xxh_round(0, xxh_read64(p));
+        h = xxh_rotl(h, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+        p += 8;
+    }
+
+    if (p + 4 <= end) {
+        h ^= (uint64_t) xxh_read32(p) * XXH_PRIME64_1;
+        h = xxh_rotl(h, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+        p += 4;
+    }
+
+    while (p < end) {
+        h ^= (uint64_t) (unsigned char) *p * XXH_PRIME64_5;
+        h = xxh_rotl(h, 11) * XXH_PRIME64_1;
+        p++;
+    }
+
+    h ^= h >> 33;
+    h *= XXH_PRIME64_2;
+    h ^= h >> 29;
+    h *= XXH_PRIME64_3;
+    h ^= h >> 32;
+
+    return h;
+}
+
+/**
+ * @brief Runs a task for each index on a small pool of threads. Indices are
+ * handed out in order, the calling thread also takes part.
+ *
+ * @param count Number of tasks.
+ * @param task Called with the index of each task, returns false on error.
+ * @param max_threads Upper limit on the number of threads used.
+ * @return True if every task succeeded.
+ */
+bool Utils::parallel_for(std::size_t count,
+                         const std::function<bool(std::size_t)>& task,
+                         std::size_t max_threads) {
+    std::size_t n_threads = std::max(1u, std::thread::hardware_concurrency());
+    n_threads = std::min({n_threads, max_threads, count});
+
+    std::atomic<std::size_t> next{0};
+    std::atomic<bool> success{true};
+
+    auto worker = [&]() {
+        std::size_t i;
+        while ((i = next++) < count) {
+            if (!task(i)) {
+                success = false;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < n_threads; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+
+    for (auto& thread: threads) {
+        thread.join();
+    }
+
+    return success;
+}
+
 bool Utils::assert_true(const char c) {
     return c == 'Y';
 }
@@ -66,37 +237,82 @@ double Utils::mils_to_millimeters(int mils) {
     return (double) mils * 0.0254;
 }
 
-std::string Utils::replace_empty_quotes(const std::string& input) {
-    std::string buf;
-    std::size_t pos = 0;
-    std::size_t prev_pos;
-    std::string empty_quotes = "\"\"";
-    std::string replacement = "\"None\"";
-
-    buf.reserve(input.size());
-
-    while (true) {
-        prev_pos = pos;
-        pos = input.find(empty_quotes, pos);
-        if (pos == std::string::npos) { break; }
-        buf.append(input, prev_pos, pos - prev_pos);
-        buf.append(replacement);
-        pos += empty_quotes.size();
+// AVX2 can be chosen at runtime on x86 builds that don't target it
+#if defined(__GNUC__) && defined(__SSE2__) && !defined(__AVX2__)
+#define KANDLE_AVX2_DISPATCH
+#endif
+
+#if defined(__AVX2__) || defined(KANDLE_AVX2_DISPATCH)
+// Converts 4 values at a time (compiled for AVX2 even if the rest of the
+// build isn't), returns how many were converted
+#if defined(KANDLE_AVX2_DISPATCH)
+__attribute__((target("avx2")))
+#endif
+static std::size_t convert_avx2(const int* mils, double* millimeters,
+                                std::size_t count) {
+    const __m256d scale = _mm256_set1_pd(0.0254);
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i values = _mm_loadu_si128((const __m128i*) (mils + i));
+        _mm256_storeu_pd(millimeters + i,
+                         _mm256_mul_pd(_mm256_cvtepi32_pd(values), scale));
     }
+    return i;
+}
+#endif
 
-    buf.append(input, prev_pos, input.size() - prev_pos);
+// Converts 2 values at a time, returns how many were converted
+static std::size_t convert_sse2(const int* mils, double* millimeters,
+                                std::size_t count) {
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    const __m128d scale = _mm_set1_pd(0.0254);
+    for (; i + 2 <= count; i += 2) {
+        __m128i values = _mm_loadl_epi64((const __m128i*) (mils + i));
+        _mm_storeu_pd(millimeters + i,
+                      _mm_mul_pd(_mm_cvtepi32_pd(values), scale));
+    }
+#endif
+    return i;
+}
 
-    return buf;
+#if defined(__AVX2__) || defined(KANDLE_AVX2_DISPATCH)
+// True if the build targets AVX2 (e.g. -mavx2) or the CPU supports it
+static bool has_avx2() {
+#if defined(__AVX2__)
+    return true;
+#else
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#endif
 }
+#endif
 
-std::string Utils::split_string_nth_space(const std::string& input, int n) {
-    size_t pos = 0;
-    for (int i = 0; i < n; i++) {
-        pos = input.find(' ', pos) + 1;
-        if (pos == std::string::npos) {
-            return "";
-        }
+/**
+ * @brief Converts an array of mils to millimeters, 4 (AVX2) or 2 (SSE2)
+ * values at a time.
+ *
+ * @note AVX2 is chosen at runtime on x86 (no compiler flag needed), SSE2
+ * is used otherwise. Each value is converted exactly as the scalar version
+ * does (an exact int to double conversion then a single multiply), so the
+ * results are bit-identical whichever path is taken.
+ *
+ * @param mils Values to convert.
+ * @param millimeters Output, at least count values.
+ * @param count Number of values.
+ */
+void Utils::mils_to_millimeters(const int* mils, double* millimeters,
+                                std::size_t count) {
+    std::size_t i;
+
+#if defined(__AVX2__) || defined(KANDLE_AVX2_DISPATCH)
+    i = has_avx2() ? convert_avx2(mils, millimeters, count) :
+                     convert_sse2(mils, millimeters, count);
+#else
+    i = convert_sse2(mils, millimeters, count);
+#endif
+
+    for (; i < count; i++) {
+        millimeters[i] = mils_to_millimeters(mils[i]);
     }
-    return input.substr(pos);
 }
-